@@ -0,0 +1,156 @@
+/**********************************
+ * DESCRIPTION: Throughput of inverting many small independent matrices with the batched
+ * kernels of batched_inverse.h, against looping lu_factor() and inverse() of linalg.h over
+ * the matrices in parallel.
+ *
+ * For each size the matrices take about 32 MB unless -c is given; the time of the batched
+ * inversion excludes packing, which a caller keeping its matrices interleaved never pays.
+ * Both methods are timed by bench.h, the median over the repeats.
+ * Both results are checked against A Inv - I on a sample of the matrices.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   COMPILE: g++ -O3 -march=native -fopenmp batched_inverse.cpp linalg.cpp -o batched_inverse
+ *   RUN: ./batched_inverse [-n size] [-c count] [-r repeats]
+ *   Without -n the sizes 4, 8, 16, 32 and 64 are run.
+**********************************/
+#include <iostream>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+#include <omp.h>
+#include "bench.h"
+#include "batched_inverse.h"
+#include "linalg.h"
+
+using namespace std;
+
+const int samples = 64;
+const double tolerance = 1e-8;
+
+/**
+ * Random diagonally dominant matrices, row-major one after the other
+ * @param n
+ * @param count
+ * @return
+ */
+vector<double> make_matrices(int n, long count) {
+    vector<double> matrices((size_t) count * n * n);
+
+#pragma omp parallel
+    {
+        mt19937 engine(1234 + omp_get_thread_num());
+        uniform_real_distribution<> u(-1.0, 1.0);
+#pragma omp for schedule(static)
+        for (long m = 0; m < count; m++) {
+            double *a = &matrices[(size_t) m * n * n];
+            for (int e = 0; e < n * n; e++)
+                a[e] = u(engine);
+            for (int i = 0; i < n; i++)
+                a[i * n + i] += n;
+        }
+    }
+    return matrices;
+}
+
+/**
+ * Largest error of A Inv - I over a sample of the matrices
+ */
+double sample_error(int n, long count, const vector<double> &matrices, const vector<double> &inverses) {
+    double error = 0;
+
+    for (long m = 0; m < count; m += max(1L, count / samples)) {
+        Matrix A(n, n), Inv(n, n);
+        copy(&matrices[(size_t) m * n * n], &matrices[(size_t) (m + 1) * n * n], A.data.begin());
+        copy(&inverses[(size_t) m * n * n], &inverses[(size_t) (m + 1) * n * n], Inv.data.begin());
+        error = max(error, inverse_error(A, Inv));
+    }
+    return error;
+}
+
+/**
+ * Time both methods for one size
+ * @param n
+ * @param count
+ * @param repeats
+ */
+void run(int n, long count, int repeats) {
+    vector<double> matrices = make_matrices(n, count);
+    vector<double> inverses(matrices.size()), soa(batched_size(n, count));
+    long singular = 0;
+    BenchOptions options;
+    options.warmup = 0;
+    options.repeats = repeats;
+
+    double batched = bench_measure("batched", omp_get_max_threads(), n, count, "mat/s", [&]() {
+        singular = batched_inverse(n, count, soa.data(), NULL);
+    }, options, [&]() {
+        batched_pack(n, count, matrices.data(), soa.data());
+    }).median;
+    batched_unpack(n, count, soa.data(), inverses.data());
+    double batched_error = sample_error(n, count, matrices, inverses);
+
+    double looped = bench_measure("looped", omp_get_max_threads(), n, count, "mat/s", [&]() {
+#pragma omp parallel
+        {
+            Matrix A(n, n), Inv;
+            LUFactors F;
+#pragma omp for schedule(static)
+            for (long m = 0; m < count; m++) {
+                copy(&matrices[(size_t) m * n * n], &matrices[(size_t) (m + 1) * n * n], A.data.begin());
+                if (lu_factor(A, F) == LINALG_OK && inverse(F, Inv) == LINALG_OK)
+                    copy(Inv.data.begin(), Inv.data.end(), &inverses[(size_t) m * n * n]);
+            }
+        }
+    }, options).median;
+    double looped_error = sample_error(n, count, matrices, inverses);
+
+    printf("%6d %10ld %16.3e %16.3e %9.1fx %12.2e %12.2e %9ld %s\n", n, count, count / batched,
+           count / looped, looped / batched, batched_error, looped_error, singular,
+           batched_error < tolerance && looped_error < tolerance ? "[CORRECT]" : "[WRONG]");
+}
+
+/**
+ * Main function
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char *argv[]) {
+    vector<int> sizes = {4, 8, 16, 32, 64};
+    long count = 0;
+    int repeats = 3, opt;
+
+    while ((opt = getopt(argc, argv, "n:c:r:")) != -1) {
+        switch (opt) {
+            case 'n':
+                sizes = {atoi(optarg)};
+                break;
+            case 'c':
+                count = atol(optarg);
+                break;
+            case 'r':
+                repeats = max(1, atoi(optarg));
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n size] [-c count] [-r repeats]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    printf("Threads: %d, lanes per group: %d\n", omp_get_max_threads(), BATCH_LANES);
+    printf("%6s %10s %16s %16s %10s %12s %12s %9s\n", "size", "count", "batched(mat/s)", "looped(mat/s)",
+           "speedup", "err_batched", "err_looped", "singular");
+    for (int n : sizes) {
+        if (n < 1) {
+            fprintf(stderr, "Invalid size %d\n", n);
+            return 1;
+        }
+        run(n, count > 0 ? count : max(1L, (32L << 20) / ((long) n * n * (long) sizeof(double))), repeats);
+    }
+    return 0;
+}
@@ -0,0 +1,215 @@
+/**********************************
+ * DESCRIPTION: Batched inversion of many small independent matrices.
+ *
+ * The matrices are interleaved by groups of BATCH_LANES: element (i, j) of the matrices of a
+ * group is stored contiguously, one per lane, so every step of the elimination is a SIMD
+ * operation across BATCH_LANES matrices instead of a short loop within one. Groups are
+ * inverted in parallel by the OpenMP threads.
+ *
+ * The kernel is Gauss-Jordan in place with partial pivoting chosen per lane: rows are swapped
+ * lane by lane, and the matching columns of the inverse are swapped back at the end. Sizes 4,
+ * 8, 16, 32 and 64 dispatch to kernels specialized at compile time, so the loops over the
+ * rows are fully known to the compiler; other sizes use the same kernel with a runtime size.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   std::vector<double> soa(batched_size(n, count));
+ *   batched_pack(n, count, matrices, soa.data());    // count row-major n x n matrices
+ *   batched_inverse(n, count, soa.data(), singular); // in place, singular[m] = 1 if singular
+ *   batched_unpack(n, count, soa.data(), matrices);
+ *
+ * USEFUL REFERENCE:
+ *    -> Gauss-Jordan: https://en.wikipedia.org/wiki/Gaussian_elimination#Finding_the_inverse_of_a_matrix
+ *    -> Batched linear algebra: https://icl.utk.edu/files/publications/2017/icl-utk-1031-2017.pdf
+**********************************/
+#ifndef BATCHED_INVERSE_H
+#define BATCHED_INVERSE_H
+
+#include <cmath>
+#include <cstddef>
+
+// Matrices per group, 8 doubles: one AVX-512 register or two AVX2 registers
+const int BATCH_LANES = 8;
+
+/**
+ * Doubles needed to hold count n x n matrices interleaved, the last group padded
+ */
+inline size_t batched_size(int n, long count) {
+    return (size_t) ((count + BATCH_LANES - 1) / BATCH_LANES) * n * n * BATCH_LANES;
+}
+
+/**
+ * Interleave count row-major n x n matrices; the padding lanes get the identity
+ * @param n
+ * @param count
+ * @param matrices  count * n * n doubles
+ * @param soa       batched_size(n, count) doubles
+ */
+inline void batched_pack(int n, long count, const double *matrices, double *soa) {
+    long groups = (count + BATCH_LANES - 1) / BATCH_LANES;
+
+#pragma omp parallel for schedule(static)
+    for (long g = 0; g < groups; g++) {
+        double *group = soa + (size_t) g * n * n * BATCH_LANES;
+        for (int l = 0; l < BATCH_LANES; l++) {
+            long m = g * BATCH_LANES + l;
+            for (int e = 0; e < n * n; e++)
+                group[e * BATCH_LANES + l] = m < count ? matrices[(size_t) m * n * n + e]
+                                                       : (e / n == e % n ? 1.0 : 0.0);
+        }
+    }
+}
+
+/**
+ * Inverse of batched_pack()
+ */
+inline void batched_unpack(int n, long count, const double *soa, double *matrices) {
+#pragma omp parallel for schedule(static)
+    for (long m = 0; m < count; m++) {
+        const double *group = soa + (size_t) (m / BATCH_LANES) * n * n * BATCH_LANES;
+        for (int e = 0; e < n * n; e++)
+            matrices[(size_t) m * n * n + e] = group[e * BATCH_LANES + m % BATCH_LANES];
+    }
+}
+
+/**
+ * Invert one group of BATCH_LANES interleaved matrices in place
+ * @tparam N       size known at compile time, or 0 to use n
+ * @param n        size when N is 0
+ * @param a        n * n * BATCH_LANES doubles
+ * @param singular BATCH_LANES flags, set to 1 for a singular lane
+ */
+template<int N>
+inline void batched_invert_group(int n, double *a, unsigned char *singular) {
+    const int size = N > 0 ? N : n;
+    const int L = BATCH_LANES;
+    int piv[N > 0 ? N : 1][BATCH_LANES];
+    int *pivots = N > 0 ? &piv[0][0] : new int[size * L];
+
+    for (int l = 0; l < L; l++)
+        singular[l] = 0;
+
+    for (int k = 0; k < size; k++) {
+        int p[BATCH_LANES];
+        double best[BATCH_LANES], inv[BATCH_LANES];
+        double *ak = a + (size_t) k * size * L;
+
+        /** Pivot of each lane */
+#pragma omp simd
+        for (int l = 0; l < L; l++) {
+            p[l] = k;
+            best[l] = std::fabs(ak[k * L + l]);
+        }
+        for (int i = k + 1; i < size; i++) {
+            const double *ai = a + (size_t) i * size * L;
+#pragma omp simd
+            for (int l = 0; l < L; l++) {
+                double v = std::fabs(ai[k * L + l]);
+                p[l] = v > best[l] ? i : p[l];
+                best[l] = v > best[l] ? v : best[l];
+            }
+        }
+
+        /** Row swaps, lane by lane */
+        for (int l = 0; l < L; l++) {
+            pivots[k * L + l] = p[l];
+            if (best[l] == 0)
+                singular[l] = 1;
+            if (p[l] != k) {
+                double *ap = a + (size_t) p[l] * size * L;
+                for (int j = 0; j < size; j++) {
+                    double t = ak[j * L + l];
+                    ak[j * L + l] = ap[j * L + l];
+                    ap[j * L + l] = t;
+                }
+            }
+        }
+
+        /** Scale the pivot row; a singular lane keeps going with a unit pivot */
+#pragma omp simd
+        for (int l = 0; l < L; l++) {
+            double d = ak[k * L + l];
+            inv[l] = 1.0 / (d != 0 ? d : 1.0);
+            ak[k * L + l] = 1.0;
+        }
+        for (int j = 0; j < size; j++) {
+#pragma omp simd
+            for (int l = 0; l < L; l++)
+                ak[j * L + l] *= inv[l];
+        }
+
+        /** Eliminate column k from every other row */
+        for (int i = 0; i < size; i++) {
+            if (i == k)
+                continue;
+            double *ai = a + (size_t) i * size * L;
+            double f[BATCH_LANES];
+#pragma omp simd
+            for (int l = 0; l < L; l++) {
+                f[l] = ai[k * L + l];
+                ai[k * L + l] = 0;
+            }
+            for (int j = 0; j < size; j++) {
+#pragma omp simd
+                for (int l = 0; l < L; l++)
+                    ai[j * L + l] -= f[l] * ak[j * L + l];
+            }
+        }
+    }
+
+    /** Undo the row swaps as column swaps of the inverse, in reverse order */
+    for (int k = size - 1; k >= 0; k--) {
+        for (int l = 0; l < L; l++) {
+            int p = pivots[k * L + l];
+            if (p == k)
+                continue;
+            for (int i = 0; i < size; i++) {
+                double *ai = a + (size_t) i * size * L;
+                double t = ai[k * L + l];
+                ai[k * L + l] = ai[p * L + l];
+                ai[p * L + l] = t;
+            }
+        }
+    }
+
+    if (N == 0)
+        delete[] pivots;
+}
+
+/**
+ * Invert count interleaved n x n matrices in place
+ * @param n
+ * @param count
+ * @param soa       batched_size(n, count) doubles, from batched_pack()
+ * @param singular  count flags, or NULL
+ * @return the number of singular matrices
+ */
+inline long batched_inverse(int n, long count, double *soa, unsigned char *singular) {
+    long groups = (count + BATCH_LANES - 1) / BATCH_LANES;
+    long num_singular = 0;
+
+#pragma omp parallel for schedule(static) reduction(+:num_singular)
+    for (long g = 0; g < groups; g++) {
+        double *group = soa + (size_t) g * n * n * BATCH_LANES;
+        unsigned char flags[BATCH_LANES];
+
+        switch (n) {
+            case 4: batched_invert_group<4>(n, group, flags); break;
+            case 8: batched_invert_group<8>(n, group, flags); break;
+            case 16: batched_invert_group<16>(n, group, flags); break;
+            case 32: batched_invert_group<32>(n, group, flags); break;
+            case 64: batched_invert_group<64>(n, group, flags); break;
+            default: batched_invert_group<0>(n, group, flags); break;
+        }
+        for (int l = 0; l < BATCH_LANES && g * BATCH_LANES + l < count; l++) {
+            num_singular += flags[l];
+            if (singular)
+                singular[g * BATCH_LANES + l] = flags[l];
+        }
+    }
+    return num_singular;
+}
+
+#endif
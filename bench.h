@@ -0,0 +1,205 @@
+/**********************************
+ * DESCRIPTION: A small benchmark harness shared by the benchmark programs of this collection.
+ *
+ * A kernel is timed with a steady clock after a number of warm-up runs, over a number of
+ * repetitions, and summarized by min, median, p95 and mean. Results print as a table and
+ * write as JSON, one result object per line, which is also the format bench_read_json()
+ * reads back to compare a run against a stored baseline.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+**********************************/
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+struct BenchOptions {
+    int warmup = 1;
+    int repeats = 10;
+};
+
+struct BenchResult {
+    std::string kernel;
+    int threads = 1;
+    long size = 0;
+    int repeats = 0;
+    double min = 0;
+    double median = 0;
+    double p95 = 0;
+    double mean = 0;
+    double work = 0;      // units of work per run, the rate is work / median
+    std::string unit;     // unit of the rate, e.g. "GFLOP/s"
+    std::string extra;    // preformatted JSON members appended to the object, e.g. counters
+
+    double rate() const {
+        return median > 0 ? work / median : 0;
+    }
+};
+
+inline double bench_now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Nearest-rank percentile of sorted samples
+ */
+inline double bench_percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty())
+        return 0;
+    size_t rank = (size_t) std::ceil(p / 100.0 * sorted.size());
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+/**
+ * Time a kernel
+ * @param kernel  name of the kernel
+ * @param threads thread count the kernel runs with, recorded only
+ * @param size    problem size, recorded only
+ * @param work    units of work per run, in the unit of the rate
+ * @param unit
+ * @param run     the kernel
+ * @param options
+ * @param setup   run untimed before every run when set, e.g. to restore an input the kernel overwrites
+ * @return
+ */
+inline BenchResult bench_measure(const std::string &kernel, int threads, long size, double work,
+                                 const std::string &unit, const std::function<void()> &run,
+                                 const BenchOptions &options = BenchOptions(),
+                                 const std::function<void()> &setup = std::function<void()>()) {
+    BenchResult result;
+    std::vector<double> samples;
+
+    for (int i = 0; i < options.warmup; i++) {
+        if (setup)
+            setup();
+        run();
+    }
+    for (int i = 0; i < options.repeats; i++) {
+        if (setup)
+            setup();
+        double start = bench_now();
+        run();
+        samples.push_back(bench_now() - start);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    result.kernel = kernel;
+    result.threads = threads;
+    result.size = size;
+    result.repeats = options.repeats;
+    result.min = samples.front();
+    result.median = samples.size() % 2 ? samples[samples.size() / 2]
+                                       : 0.5 * (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]);
+    result.p95 = bench_percentile(samples, 95);
+    for (double s : samples)
+        result.mean += s / samples.size();
+    result.work = work;
+    result.unit = unit;
+    return result;
+}
+
+inline void bench_print_header() {
+    printf("%-22s %8s %12s %12s %12s %12s %14s\n",
+           "kernel", "threads", "size", "min(ms)", "median(ms)", "p95(ms)", "rate");
+}
+
+inline void bench_print(const BenchResult &r) {
+    printf("%-22s %8d %12ld %12.3f %12.3f %12.3f %9.3f %s\n", r.kernel.c_str(), r.threads, r.size,
+           r.min * 1e3, r.median * 1e3, r.p95 * 1e3, r.rate(), r.unit.c_str());
+}
+
+inline void bench_write_json(std::ostream &out, const std::vector<BenchResult> &results) {
+    char host[256] = "unknown", date[64];
+    time_t t = time(nullptr);
+
+    gethostname(host, sizeof(host));
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&t));
+    out << "{\n  \"host\": \"" << host << "\",\n  \"date\": \"" << date << "\",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        char line[1024];
+        snprintf(line, sizeof(line),
+                 "    {\"kernel\": \"%s\", \"threads\": %d, \"size\": %ld, \"repeats\": %d, "
+                 "\"min\": %.9g, \"median\": %.9g, \"p95\": %.9g, \"mean\": %.9g, \"rate\": %.9g, \"unit\": \"%s\"",
+                 r.kernel.c_str(), r.threads, r.size, r.repeats, r.min, r.median, r.p95, r.mean, r.rate(),
+                 r.unit.c_str());
+        out << line << r.extra << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+/**
+ * Value of a member in a one-line JSON object written by bench_write_json()
+ */
+inline std::string bench_json_member(const std::string &line, const std::string &key) {
+    size_t pos = line.find("\"" + key + "\":");
+    if (pos == std::string::npos)
+        return "";
+    pos = line.find_first_not_of(' ', pos + key.size() + 3);
+    if (line[pos] == '"')
+        return line.substr(pos + 1, line.find('"', pos + 1) - pos - 1);
+    return line.substr(pos, line.find_first_of(",}", pos) - pos);
+}
+
+inline std::vector<BenchResult> bench_read_json(std::istream &in) {
+    std::vector<BenchResult> results;
+    std::string line;
+
+    while (std::getline(in, line)) {
+        if (line.find("\"kernel\":") == std::string::npos)
+            continue;
+        BenchResult r;
+        r.kernel = bench_json_member(line, "kernel");
+        r.threads = std::stoi(bench_json_member(line, "threads"));
+        r.size = std::stol(bench_json_member(line, "size"));
+        r.repeats = std::stoi(bench_json_member(line, "repeats"));
+        r.min = std::stod(bench_json_member(line, "min"));
+        r.median = std::stod(bench_json_member(line, "median"));
+        r.p95 = std::stod(bench_json_member(line, "p95"));
+        r.mean = std::stod(bench_json_member(line, "mean"));
+        r.unit = bench_json_member(line, "unit");
+        r.work = std::stod(bench_json_member(line, "rate")) * r.median;
+        results.push_back(r);
+    }
+    return results;
+}
+
+/**
+ * Compare the medians of a run against a baseline, matching kernel, thread count and size
+ * @param tolerance  relative slowdown still accepted, e.g. 0.05
+ * @return the number of regressions
+ */
+inline int bench_compare(const std::vector<BenchResult> &current, const std::vector<BenchResult> &baseline,
+                         double tolerance) {
+    int regressions = 0;
+
+    printf("%-22s %8s %12s %14s %14s %9s\n", "kernel", "threads", "size", "baseline(ms)", "current(ms)", "change");
+    for (const BenchResult &c : current) {
+        auto b = std::find_if(baseline.begin(), baseline.end(), [&](const BenchResult &b) {
+            return b.kernel == c.kernel && b.threads == c.threads && b.size == c.size;
+        });
+        if (b == baseline.end()) {
+            printf("%-22s %8d %12ld %14s %14.3f %9s\n", c.kernel.c_str(), c.threads, c.size, "-",
+                   c.median * 1e3, "new");
+            continue;
+        }
+        double change = c.median / b->median - 1.0;
+        bool regressed = change > tolerance;
+        regressions += regressed;
+        printf("%-22s %8d %12ld %14.3f %14.3f %+8.1f%%%s\n", c.kernel.c_str(), c.threads, c.size,
+               b->median * 1e3, c.median * 1e3, change * 100, regressed ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
+
+#endif
@@ -0,0 +1,380 @@
+/**********************************
+ * DESCRIPTION: A single benchmark driver for the kernels of this collection, using bench.h.
+ *
+ * Runs each kernel for a sweep of thread counts with warm-up and repetitions, prints
+ * min/median/p95 and the rate, optionally writes the results as JSON, and compares them
+ * against a stored baseline, exiting with 1 when a median regressed beyond the tolerance.
+ *
+ * The kernels are the hot loops of the programs, called from the headers the programs use;
+ * the loops written inside the main() of a C program are copies here, marked (copy):
+ *   matmul            (copy) the product of omp_saxp.c, in cache-friendly i-k-j order
+ *   matmul_rec        multiply_recursive() of linalg.h, the same product by cache-oblivious recursion
+ *   matvec            lowp_matvec() on int storage, the mat-vec of matrix-multiplication-openmp.cpp
+ *   matvec_i8         the same on int8 storage
+ *   matvec_bits       the same on bit-packed storage
+ *   lu                lu_factor() of linalg.h, used by matrix_inverse.cpp
+ *   cholesky          chol_factor() of linalg.h, on a symmetric positive-definite matrix
+ *   stream_triad      (copy) the triad of stream.c
+ *   parfor            (copy) the update loop of omp_parfor.c
+ *   histogram         histogram_count() of histogram.h, the binning of every rank of histogram.cpp;
+ *                     serial, one rank per core, so the threads only run copies side by side
+ *   histogram_shared  histogram_count_shared() of histogram.h, the atomic binning of question 5
+ *   reduction         (copy) the sum of main.cpp's reduction benchmark
+ *   divisibility      (copy) the modulo test of div_3_4.c
+ *   div_wheel         wheel_count_scan() of div_wheel.h for the divisors 3 and 4
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   COMPILE: g++ -O3 -march=native -fopenmp -std=c++17 benchmark.cpp linalg.cpp -o benchmark
+ *   RUN: ./benchmark [--threads 1,2,4] [--repeats N] [--warmup N] [--scale F] [--filter name,...]
+ *                    [--json out.json] [--compare baseline.json] [--tolerance 0.05] [--counters]
+ *
+ *   --counters runs every kernel once more under the perf_event counters of perf_counters.h
+ *   and adds cycles, IPC, miss rates and arithmetic intensity to the output and the JSON.
+**********************************/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <omp.h>
+#include "bench.h"
+#include "linalg.h"
+#include "lowp_matvec.h"
+#include "histogram.h"
+#include "div_wheel.h"
+#include "perf_counters.h"
+
+using namespace std;
+
+// Keeps the results of the reductions alive
+volatile double sink;
+
+// Set by --counters
+bool counters = false;
+
+/**
+ * bench_measure(), plus one more run under the perf counters with --counters
+ * @param flops  FLOPs per run, 0 for integer kernels
+ */
+BenchResult measure(const string &kernel, int threads, long size, double work, const string &unit,
+                    double flops, const function<void()> &run, const BenchOptions &options) {
+    BenchResult result = bench_measure(kernel, threads, size, work, unit, run, options);
+
+    if (counters) {
+        static perf_region_t region;
+        char extra[512];
+        perf_region_init(&region, kernel.c_str());
+        perf_region_begin(&region);
+        run();
+        perf_region_end(&region);
+        perf_region_json(&region, flops, extra, sizeof(extra));
+        result.extra = extra;
+        perf_region_report(&region, flops);
+    }
+    return result;
+}
+
+struct Kernel {
+    const char *name;
+    long size;
+    BenchResult (*run)(long n, int threads, const BenchOptions &options);
+};
+
+BenchResult bench_matmul(long n, int threads, const BenchOptions &options) {
+    vector<double> a(n * n), b(n * n), c(n * n);
+    for (long i = 0; i < n * n; i++) {
+        a[i] = (double) (i % 7);
+        b[i] = (double) (i % 5);
+    }
+
+    return measure("matmul", threads, n, 2.0 * n * n * n * 1e-9, "GFLOP/s", 2.0 * n * n * n, [&]() {
+#pragma omp parallel for schedule(static)
+        for (long i = 0; i < n; i++) {
+            double *ci = &c[i * n];
+            for (long j = 0; j < n; j++)
+                ci[j] = 0;
+            for (long k = 0; k < n; k++) {
+                double r = a[i * n + k];
+                const double *bk = &b[k * n];
+                for (long j = 0; j < n; j++)
+                    ci[j] += r * bk[j];
+            }
+        }
+    }, options);
+}
+
+BenchResult bench_matmul_rec(long n, int threads, const BenchOptions &options) {
+    Matrix a(n, n), b(n, n), c;
+    for (long i = 0; i < n * n; i++) {
+        a.data[i] = (double) (i % 7);
+        b.data[i] = (double) (i % 5);
+    }
+
+    return measure("matmul_rec", threads, n, 2.0 * n * n * n * 1e-9, "GFLOP/s", 2.0 * n * n * n, [&]() {
+        multiply_recursive(a, b, c);
+    }, options);
+}
+
+template<class T>
+BenchResult bench_matvec_lowp(const char *name, long n, int threads, const BenchOptions &options) {
+    LowpMatrix<T> x(n, n), y(1, n);
+    vector<int> result(n);
+    for (long i = 0; i < n; i++)
+        for (long j = 0; j < n; j++)
+            x.set(i, j, (int) ((i * n + j) * 2654435761UL >> 20) & 1);
+    for (long i = 0; i < n; i++)
+        y.set(0, i, (int) (i * 40503UL >> 7) & 1);
+
+    return measure(name, threads, n, 2.0 * n * n * 1e-9, "GOP/s", 0, [&]() {
+        lowp_matvec(x, y, result.data());
+    }, options);
+}
+
+BenchResult bench_matvec(long n, int threads, const BenchOptions &options) {
+    return bench_matvec_lowp<int>("matvec", n, threads, options);
+}
+
+BenchResult bench_matvec_i8(long n, int threads, const BenchOptions &options) {
+    return bench_matvec_lowp<int8_t>("matvec_i8", n, threads, options);
+}
+
+BenchResult bench_matvec_bits(long n, int threads, const BenchOptions &options) {
+    return bench_matvec_lowp<bool>("matvec_bits", n, threads, options);
+}
+
+BenchResult bench_lu(long n, int threads, const BenchOptions &options) {
+    Matrix a(n, n);
+    LUFactors f;
+    for (long i = 0; i < n; i++)
+        for (long j = 0; j < n; j++)
+            a(i, j) = (i == j ? n : 0) + (double) ((i * 31 + j * 17) % 100) / 100.0;
+
+    return measure("lu", threads, n, 2.0 / 3.0 * n * n * n * 1e-9, "GFLOP/s", 2.0 / 3.0 * n * n * n, [&]() {
+        lu_factor(a, f);
+    }, options);
+}
+
+BenchResult bench_cholesky(long n, int threads, const BenchOptions &options) {
+    Matrix a(n, n);
+    CholeskyFactors f;
+    for (long i = 0; i < n; i++)
+        for (long j = 0; j <= i; j++)
+            a(i, j) = a(j, i) = (i == j ? n : 0) + (double) ((i * 31 + j * 17) % 100) / 100.0;
+
+    return measure("cholesky", threads, n, 1.0 / 3.0 * n * n * n * 1e-9, "GFLOP/s", 1.0 / 3.0 * n * n * n, [&]() {
+        chol_factor(a, f);
+    }, options);
+}
+
+BenchResult bench_stream_triad(long n, int threads, const BenchOptions &options) {
+    double *a = new double[n], *b = new double[n], *c = new double[n];
+#pragma omp parallel for schedule(static)
+    for (long i = 0; i < n; i++) {
+        a[i] = 1.0;
+        b[i] = 2.0;
+        c[i] = 0.5;
+    }
+
+    BenchResult r = measure("stream_triad", threads, n, 3.0 * n * sizeof(double) * 1e-9, "GB/s", 2.0 * n, [&]() {
+#pragma omp parallel for simd schedule(static)
+        for (long i = 0; i < n; i++)
+            a[i] = b[i] + 3.0 * c[i];
+    }, options);
+    delete[] a;
+    delete[] b;
+    delete[] c;
+    return r;
+}
+
+BenchResult bench_parfor(long n, int threads, const BenchOptions &options) {
+    double *a = new double[n], *b = new double[n];
+#pragma omp parallel for schedule(static)
+    for (long i = 0; i < n; i++) {
+        a[i] = 2.0 * i;
+        b[i] = i % 3;
+    }
+
+    BenchResult r = measure("parfor", threads, n, 3.0 * n * sizeof(double) * 1e-9, "GB/s", 2.0 * n, [&]() {
+#pragma omp parallel for schedule(static)
+        for (long i = 0; i < n; i++)
+            a[i] += 2.0 * b[i];
+    }, options);
+    delete[] a;
+    delete[] b;
+    return r;
+}
+
+BenchResult bench_histogram(long n, int threads, const BenchOptions &options) {
+    const int num_bins = 100, min_range = 1, max_range = 1000;
+    const int range = histogram_range(min_range, max_range, num_bins);
+    vector<int> data(n);
+    vector<int> bins((size_t) threads * num_bins);
+    for (long i = 0; i < n; i++)
+        data[i] = min_range + (int) ((i * 2654435761UL >> 8) % (max_range - min_range + 1));
+
+    return measure("histogram", threads, n, (double) n * threads * 1e-9, "Gelem/s", 0, [&]() {
+        fill(bins.begin(), bins.end(), 0);
+#pragma omp parallel
+        histogram_count(data.data(), n, min_range, range, &bins[(size_t) omp_get_thread_num() * num_bins]);
+    }, options);
+}
+
+BenchResult bench_histogram_shared(long n, int threads, const BenchOptions &options) {
+    const int num_bins = 100, min_range = 1, max_range = 1000;
+    const int range = histogram_range(min_range, max_range, num_bins);
+    vector<int> data(n);
+    vector<int> bins(num_bins);
+    for (long i = 0; i < n; i++)
+        data[i] = min_range + (int) ((i * 2654435761UL >> 8) % (max_range - min_range + 1));
+
+    return measure("histogram_shared", threads, n, n * 1e-9, "Gelem/s", 0, [&]() {
+        fill(bins.begin(), bins.end(), 0);
+        histogram_count_shared(data.data(), n, min_range, range, bins.data());
+    }, options);
+}
+
+BenchResult bench_reduction(long n, int threads, const BenchOptions &options) {
+    return measure("reduction", threads, n, n * 1e-9, "Gelem/s", 2.0 * n, [&]() {
+        double sum = 0;
+#pragma omp parallel for reduction(+:sum)
+        for (long i = 0; i < n; i++)
+            sum += (double) (((unsigned long) i * 2654435761UL) & 0xFFFFFF) * (1.0 / 16777216.0);
+        sink = sum;
+    }, options);
+}
+
+BenchResult bench_divisibility(long n, int threads, const BenchOptions &options) {
+    return measure("divisibility", threads, n, n * 1e-9, "Gelem/s", 0, [&]() {
+        long count = 0;
+#pragma omp parallel for reduction(+:count)
+        for (long i = 1; i <= n; i++)
+            count += (i % 3 == 0) | (i % 4 == 0);
+        sink = count;
+    }, options);
+}
+
+BenchResult bench_div_wheel(long n, int threads, const BenchOptions &options) {
+    const uint64_t divisors[] = {3, 4};
+    wheel_t wheel;
+    wheel_init(&wheel, divisors, 2, false);
+
+    BenchResult r = measure("div_wheel", threads, n, n * 1e-9, "Gelem/s", 0, [&]() {
+        sink = wheel_count_scan(&wheel, 1, n + 1);
+    }, options);
+    wheel_free(&wheel);
+    return r;
+}
+
+const Kernel kernels[] = {
+        {"matmul",            512,       bench_matmul},
+        {"matmul_rec",        512,       bench_matmul_rec},
+        {"matvec",            4000,      bench_matvec},
+        {"matvec_i8",         4000,      bench_matvec_i8},
+        {"matvec_bits",       4000,      bench_matvec_bits},
+        {"lu",                400,       bench_lu},
+        {"cholesky",          400,       bench_cholesky},
+        {"stream_triad",      1L << 24,  bench_stream_triad},
+        {"parfor",            1L << 24,  bench_parfor},
+        {"histogram",         1L << 24,  bench_histogram},
+        {"histogram_shared",  1L << 24,  bench_histogram_shared},
+        {"reduction",         1L << 26,  bench_reduction},
+        {"divisibility",      1L << 26,  bench_divisibility},
+        {"div_wheel",         1L << 34,  bench_div_wheel},
+};
+
+vector<string> split(const string &s) {
+    vector<string> parts;
+    stringstream ss(s);
+    string part;
+    while (getline(ss, part, ','))
+        if (!part.empty())
+            parts.push_back(part);
+    return parts;
+}
+
+int main(int argc, char *argv[]) {
+    BenchOptions options;
+    vector<int> thread_counts;
+    vector<string> filter;
+    string json_path, compare_path;
+    double scale = 1.0, tolerance = 0.05;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--threads") {
+            for (const string &t : split(value))
+                thread_counts.push_back(stoi(t));
+            i++;
+        } else if (arg == "--repeats") {
+            options.repeats = max(1, atoi(value));
+            i++;
+        } else if (arg == "--warmup") {
+            options.warmup = atoi(value);
+            i++;
+        } else if (arg == "--scale") {
+            scale = atof(value);
+            i++;
+        } else if (arg == "--filter") {
+            filter = split(value);
+            i++;
+        } else if (arg == "--json") {
+            json_path = value;
+            i++;
+        } else if (arg == "--compare") {
+            compare_path = value;
+            i++;
+        } else if (arg == "--counters") {
+            counters = true;
+        } else if (arg == "--tolerance") {
+            tolerance = atof(value);
+            i++;
+        } else {
+            cerr << "Usage: " << argv[0] << " [--threads 1,2,4] [--repeats N] [--warmup N] [--scale F]"
+                 << " [--filter name,...] [--json out.json] [--compare baseline.json] [--tolerance 0.05]"
+                 << " [--counters]" << endl;
+            return 2;
+        }
+    }
+    if (thread_counts.empty()) {
+        for (int t = 1; t < omp_get_max_threads(); t *= 2)
+            thread_counts.push_back(t);
+        thread_counts.push_back(omp_get_max_threads());
+    }
+
+    vector<BenchResult> results;
+    bench_print_header();
+    for (const Kernel &k : kernels) {
+        if (!filter.empty() && find(filter.begin(), filter.end(), k.name) == filter.end())
+            continue;
+        long n = max(1L, (long) (k.size * scale));
+        for (int t : thread_counts) {
+            omp_set_num_threads(t);
+            results.push_back(k.run(n, t, options));
+            bench_print(results.back());
+        }
+    }
+
+    if (!json_path.empty()) {
+        ofstream out(json_path);
+        bench_write_json(out, results);
+        cout << "Results written to " << json_path << endl;
+    }
+
+    if (!compare_path.empty()) {
+        ifstream in(compare_path);
+        if (!in) {
+            cerr << "Cannot read the baseline " << compare_path << endl;
+            return 2;
+        }
+        cout << endl;
+        int regressions = bench_compare(results, bench_read_json(in), tolerance);
+        cout << regressions << " regression(s) beyond " << tolerance * 100 << "%" << endl;
+        return regressions > 0 ? 1 : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,268 @@
+/**********************************
+ * DESCRIPTION: Parallel reader of numbers from CSV or whitespace separated text files.
+ *
+ * The file is mapped with mmap and cut into chunks, one every few MB; every chunk boundary
+ * moves forward to just after a newline, so no line is split. The threads parse the chunks
+ * with std::from_chars, without iostreams, locales or a string per value, each into one
+ * vector of its chunk, and the chunks are then copied into the result at their offsets.
+ * Plain decimals of up to 15 digits without exponent, most of real data, take a fast path:
+ * the digits as an integer divided by a power of ten, both exact doubles, so the one
+ * division rounds correctly, as from_chars would.
+ *
+ * Values are separated by commas, semicolons, spaces or tabs, one row per line. A field may be
+ * quoted, "1.5", and loses one pair of quotes. An empty field, as in 1,,2 or a comma ending
+ * the line, is a parse error rather than skipped, since skipping it would shift the columns.
+ * Empty lines and the rest of a line after '#' are ignored, and a first line holding a field
+ * that is not a number is taken as a header and skipped.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   vector<double> values;
+ *   long rows, cols;
+ *   if (csv_read("data.csv", values) != CSV_OK) ...             // all values, in order
+ *   if (csv_read("matrix.csv", values, &rows, &cols) != CSV_OK) ... // rows of equal length
+ *   Needs C++17 for std::from_chars of doubles (GCC 11 or later).
+ *
+ * USEFUL REFERENCE:
+ *    -> from_chars: https://en.cppreference.com/w/cpp/utility/from_chars
+ *    -> mmap: https://man7.org/linux/man-pages/man2/mmap.2.html
+**********************************/
+#ifndef CSV_READER_H
+#define CSV_READER_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+enum CsvStatus {
+    CSV_OK = 0,
+    CSV_OPEN = 1,          // the file cannot be opened or mapped
+    CSV_PARSE = 2,         // a field is not a number or is empty
+    CSV_RAGGED = 3         // rows of different lengths, when the columns are asked for
+};
+
+const size_t CSV_CHUNK = 4 << 20;
+
+inline bool csv_separator(char c) {
+    return c == ',' || c == ';' || c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool csv_delimiter(char c) {
+    return c == ',' || c == ';';
+}
+
+/**
+ * Parse a number at p, by the fast path when it is a short plain decimal
+ * @return the end of the number, or NULL when it is not one
+ */
+inline const char *csv_parse_number(const char *p, const char *end, double &v) {
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15};
+    const char *q = p;
+    bool negative = q < end && *q == '-';
+    q += negative;
+    unsigned long long mantissa = 0;
+    int digits = 0, decimals = 0;
+    for (; q < end && (unsigned) (*q - '0') < 10; q++, digits++)
+        mantissa = mantissa * 10 + (*q - '0');
+    if (q < end && *q == '.') {
+        for (q++; q < end && (unsigned) (*q - '0') < 10; q++, digits++, decimals++)
+            mantissa = mantissa * 10 + (*q - '0');
+    }
+    if (digits > 0 && digits <= 15 && (q == end || csv_separator(*q) || *q == '#')) {
+        v = (double) mantissa / powers[decimals];
+        v = negative ? -v : v;
+        return q;
+    }
+
+    std::from_chars_result r = std::from_chars(p, end, v);
+    if (r.ec != std::errc() || (r.ptr < end && !csv_separator(*r.ptr) && *r.ptr != '#'))
+        return NULL;
+    return r.ptr;
+}
+
+/**
+ * Append the numbers of the line [p, end) to out
+ * @return the number of values, -1 when a field is not a number, or -2 when the only fault
+ *         is an empty field
+ */
+inline long csv_parse_line(const char *p, const char *end, std::vector<double> &out) {
+    long count = 0;
+    bool open = false,         // a comma or semicolon still waits for its field
+            empty = false;
+    while (true) {
+        while (p < end && csv_separator(*p) && !csv_delimiter(*p))
+            p++;
+        if (p == end || *p == '#')
+            return empty || open ? -2 : count;
+        if (csv_delimiter(*p)) {
+            empty = empty || open || count == 0;
+            open = true;
+            p++;
+            continue;
+        }
+
+        /** One pair of quotes around a field is dropped */
+        const char *field_end = end;
+        bool quoted = *p == '"';
+        if (quoted) {
+            p++;
+            field_end = (const char *) memchr(p, '"', end - p);
+            if (field_end == NULL)
+                return -1;
+        }
+        if (p < field_end && *p == '+')
+            p++;
+        double v;
+        const char *q = csv_parse_number(p, field_end, v);
+        if (q == NULL || (quoted && q != field_end))
+            return -1;
+        p = quoted ? field_end + 1 : q;
+        out.push_back(v);
+        count++;
+        open = false;
+    }
+}
+
+/**
+ * Values and shape of the lines in [begin, end)
+ */
+struct CsvChunk {
+    std::vector<double> values;
+    long rows = 0;
+    long cols = -1;            // length of the first row, -1 without rows
+    bool ragged = false;
+    bool bad = false;
+};
+
+inline void csv_parse_chunk(const char *begin, const char *end, CsvChunk &chunk) {
+    chunk.values.reserve((end - begin) / 8);
+    for (const char *p = begin; p < end;) {
+        const char *line_end = (const char *) memchr(p, '\n', end - p);
+        if (line_end == NULL)
+            line_end = end;
+        long count = csv_parse_line(p, line_end, chunk.values);
+        if (count < 0) {
+            chunk.bad = true;
+            return;
+        }
+        if (count > 0) {
+            chunk.rows++;
+            if (chunk.cols < 0)
+                chunk.cols = count;
+            else if (count != chunk.cols)
+                chunk.ragged = true;
+        }
+        p = line_end + 1;
+    }
+}
+
+/**
+ * Read all the numbers of a file, in order
+ * @param path
+ * @param values  the numbers, row after row
+ * @param rows    when not NULL, set to the number of non-empty rows
+ * @param cols    when not NULL, set to the length of the rows, which must all be equal
+ * @return CSV_OK or a CSV_* error code
+ */
+inline int csv_read(const char *path, std::vector<double> &values, long *rows = NULL, long *cols = NULL) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return CSV_OPEN;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return CSV_OPEN;
+    }
+    size_t size = (size_t) st.st_size;
+
+    values.clear();
+    if (rows)
+        *rows = 0;
+    if (cols)
+        *cols = 0;
+    if (size == 0) {
+        close(fd);
+        return CSV_OK;
+    }
+    char *map = (char *) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return CSV_OPEN;
+    madvise(map, size, MADV_WILLNEED);
+    const char *begin = map, *end = map + size;
+
+    /** Skip the empty lines and a header at the start; a line failing only by an empty field is data */
+    std::vector<double> first;
+    while (begin < end) {
+        const char *line_end = (const char *) memchr(begin, '\n', end - begin);
+        line_end = line_end ? line_end : end;
+        long count = csv_parse_line(begin, line_end, first);
+        if (count != 0) {
+            if (count == -1)
+                begin = line_end + 1;
+            break;
+        }
+        begin = line_end + 1;
+    }
+    begin = begin < end ? begin : end;
+
+    /** Chunk boundaries just after a newline */
+    size_t num_chunks = (end - begin) / CSV_CHUNK + 1;
+    std::vector<const char *> bounds(num_chunks + 1);
+    bounds[0] = begin;
+    for (size_t c = 1; c < num_chunks; c++) {
+        const char *p = begin + (end - begin) * c / num_chunks;
+        p = std::max(p, bounds[c - 1]);
+        const char *newline = (const char *) memchr(p, '\n', end - p);
+        bounds[c] = newline ? newline + 1 : end;
+    }
+    bounds[num_chunks] = end;
+
+    std::vector<CsvChunk> chunks(num_chunks);
+    std::vector<size_t> offsets(num_chunks + 1, 0);
+#pragma omp parallel for schedule(dynamic)
+    for (size_t c = 0; c < num_chunks; c++)
+        csv_parse_chunk(bounds[c], bounds[c + 1], chunks[c]);
+
+    int status = CSV_OK;
+    long total_rows = 0, row_length = -1;
+    for (size_t c = 0; c < num_chunks; c++) {
+        if (chunks[c].bad) {
+            status = CSV_PARSE;
+            break;
+        }
+        if (chunks[c].cols >= 0) {
+            if (chunks[c].ragged || (row_length >= 0 && chunks[c].cols != row_length))
+                status = cols ? CSV_RAGGED : status;
+            if (row_length < 0)
+                row_length = chunks[c].cols;
+        }
+        total_rows += chunks[c].rows;
+        offsets[c + 1] = offsets[c] + chunks[c].values.size();
+    }
+
+    if (status == CSV_OK) {
+        values.resize(offsets[num_chunks]);
+#pragma omp parallel for schedule(dynamic)
+        for (size_t c = 0; c < num_chunks; c++) {
+            std::copy(chunks[c].values.begin(), chunks[c].values.end(), values.begin() + offsets[c]);
+            std::vector<double>().swap(chunks[c].values);
+        }
+        if (rows)
+            *rows = total_rows;
+        if (cols)
+            *cols = row_length < 0 ? 0 : row_length;
+    }
+    munmap(map, size);
+    return status;
+}
+
+#endif
@@ -1,45 +1,162 @@
 /**********************************
  * DESCRIPTION: A program to calculate PI using Monte Carlo method in MPI.
  *
+ * By default every rank throws NUM_THROWS darts per round and the rounds end with an
+ * MPI_Reduce, so every round runs at the pace of the slowest rank. In dynamic mode the same
+ * total of darts is handed out in chunks of CHUNK_THROWS on demand: a counter in an MPI
+ * window on rank 0 is advanced with MPI_Fetch_and_op, so faster ranks take more chunks and
+ * all of them finish together. Both modes end with the throughput of every rank.
+ *
  * Author: Kejie Zhang
- * LAST UPDATED: 03/5/2019
+ * LAST UPDATED: 10/18/2026
  *
  * USAGE:
  *   COMPILE: mpiCC dart_pi_mpi.c -o dart_pi_mpi
- *   RUN: mpirun -np <number of processes> ./dart_pi_mpi
+ *   RUN: mpirun -np <number of processes> ./dart_pi_mpi [dynamic]
  *
  * USEFUL REFERENCE:
  *    -> MPI: https://computing.llnl.gov/tutorials/openMP/
  *    -> Monte Carlo: http://www.thephysicsmill.com/2014/05/03/throwing-darts-pi/
+ *    -> One-sided communication: https://www.mpi-forum.org/docs/mpi-3.1/mpi31-report/node262.htm
 **********************************/
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "mpi.h"
 
 #define NUM_THROWS 200000000
 #define ROUNDS 10
+#define CHUNK_THROWS 1000000
 #define PI 3.141592653589793
 
+/**
+ * Throw darts at the square [-1, 1]^2
+ * @param throws
+ * @return the number inside the unit circle
+ */
+unsigned long throwDarts(unsigned long throws) {
+    unsigned long count = 0,
+                  j;
+    double x,
+           y;
+
+    for(j = 0; j < throws; j++) {
+        x = (2.0 * (double)random()/RAND_MAX) - 1.0;
+        y = (2.0 * (double)random()/RAND_MAX) - 1.0;
+
+        if(x * x + y * y <= 1.0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Take chunks from the counter on rank 0 until all are taken
+ * @param rank_id
+ * @param num_procs
+ * @param stats  set to the darts, chunks and seconds of this rank
+ * @return the hits of this rank
+ */
+unsigned long runDynamic(int rank_id, int num_procs, double stats[3]) {
+    MPI_Win win;
+    long *counter,
+         one = 1,
+         chunk,
+         num_chunks = (long)NUM_THROWS * ROUNDS * num_procs / CHUNK_THROWS;
+    unsigned long hits = 0;
+    double start;
+
+    MPI_Win_allocate(rank_id == 0 ? sizeof(long) : 0, sizeof(long), MPI_INFO_NULL,
+                     MPI_COMM_WORLD, &counter, &win);
+    if(rank_id == 0) {
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, win);
+        *counter = 0;
+        MPI_Win_unlock(0, win);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    stats[0] = stats[1] = 0;
+    start = MPI_Wtime();
+    MPI_Win_lock_all(0, win);
+    while(1) {
+        MPI_Fetch_and_op(&one, &chunk, MPI_LONG, 0, 0, MPI_SUM, win);
+        MPI_Win_flush(0, win);
+        if(chunk >= num_chunks) {
+            break;
+        }
+        hits += throwDarts(CHUNK_THROWS);
+        stats[0] += CHUNK_THROWS;
+        stats[1]++;
+    }
+    MPI_Win_unlock_all(win);
+    stats[2] = MPI_Wtime() - start;
+
+    MPI_Win_free(&win);
+    return hits;
+}
+
+/**
+ * Print the darts, chunks and throughput of every rank on rank 0
+ * @param stats      darts, chunks and seconds of this rank
+ * @param proc_name
+ * @param rank_id
+ * @param num_procs
+ */
+void printThroughput(double stats[3], char proc_name[], int rank_id, int num_procs) {
+    double *all_stats = NULL,
+           total = 0;
+    char *names = NULL;
+    int i;
+
+    if(rank_id == 0) {
+        all_stats = (double *)malloc(sizeof(double) * 3 * num_procs);
+        names = (char *)malloc(MPI_MAX_PROCESSOR_NAME * num_procs);
+    }
+    MPI_Gather(stats, 3, MPI_DOUBLE, all_stats, 3, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Gather(proc_name, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, names, MPI_MAX_PROCESSOR_NAME, MPI_CHAR,
+               0, MPI_COMM_WORLD);
+
+    if(rank_id == 0) {
+        for(i = 0; i < num_procs; i++) {
+            total += all_stats[3 * i];
+        }
+        printf("\n%-6s %-20s %14s %8s %10s %10s %8s\n",
+               "rank", "processor", "darts", "chunks", "time(s)", "Mdarts/s", "share");
+        for(i = 0; i < num_procs; i++) {
+            printf("%-6d %-20.20s %14.0f %8.0f %10.3f %10.2f %7.1f%%\n",
+                   i, names + i * MPI_MAX_PROCESSOR_NAME, all_stats[3 * i], all_stats[3 * i + 1],
+                   all_stats[3 * i + 2], all_stats[3 * i] / all_stats[3 * i + 2] * 1e-6,
+                   100.0 * all_stats[3 * i] / total);
+        }
+        free(all_stats);
+        free(names);
+    }
+}
+
 int main(int argc, char* argv[]) {
     int rank_id,
         num_procs,
         i,
-        name_len;
-    double x,
-           y,
-           local_pi,
-           aver_pi,
+        name_len,
+        dynamic;
+    double local_pi,
+           aver_pi = 0,
            sum_pi,
            start,
-           stop;
+           stop,
+           round_start,
+           stats[3] = {0, 0, 0};
     unsigned long count,
-                  j;
+                  total_count;
     char proc_name[MPI_MAX_PROCESSOR_NAME];
 
     MPI_Init(&argc,&argv);
     MPI_Comm_size(MPI_COMM_WORLD,&num_procs);
     MPI_Comm_rank(MPI_COMM_WORLD,&rank_id);
+    memset(proc_name, 0, sizeof(proc_name));
     MPI_Get_processor_name(proc_name, &name_len);
+    dynamic = argc > 1 && strcmp(argv[1], "dynamic") == 0;
 
     /** Start the work*/
     printf("Processor %s, rank %d out of %d processors starts to work\n",
@@ -47,34 +164,39 @@ int main(int argc, char* argv[]) {
     start = MPI_Wtime();
     srandom(rank_id * rank_id);
 
-    for(i = 0; i < ROUNDS; i++) {
-        /**
-         * Calculate the pi
-         */
-        count = 0;
-        for(j = 0; j <= NUM_THROWS; j++) {
-            x = (2.0 * (double)random()/RAND_MAX) - 1.0;
-            y = (2.0 * (double)random()/RAND_MAX) - 1.0;
-
-            if(x * x + y * y <= 1.0) {
-                count++;
-            }
+    if(dynamic) {
+        count = runDynamic(rank_id, num_procs, stats);
+        MPI_Reduce(&count, &total_count, 1, MPI_UNSIGNED_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+        if(rank_id == 0) {
+            aver_pi = 4.0 * total_count / ((double)NUM_THROWS * ROUNDS * num_procs);
         }
+    } else {
+        for(i = 0; i < ROUNDS; i++) {
+            /**
+             * Calculate the pi
+             */
+            round_start = MPI_Wtime();
+            count = throwDarts(NUM_THROWS + 1);
+            stats[0] += NUM_THROWS + 1;
+            stats[1]++;
+            stats[2] += MPI_Wtime() - round_start;
 
-        local_pi = (double)(4.0 * count / NUM_THROWS);
+            local_pi = (double)(4.0 * count / NUM_THROWS);
 
-        /** Reduce the result*/
-        MPI_Reduce(&local_pi, &sum_pi, 1, MPI_DOUBLE, MPI_SUM,
-                        0, MPI_COMM_WORLD);
+            /** Reduce the result*/
+            MPI_Reduce(&local_pi, &sum_pi, 1, MPI_DOUBLE, MPI_SUM,
+                            0, MPI_COMM_WORLD);
 
-        if(rank_id == 0) {
-            aver_pi = ((aver_pi * i) + sum_pi / num_procs) / (i + 1);
-            printf("ROUND %d, the value of PI is %.15f\n", i, aver_pi);
+            if(rank_id == 0) {
+                aver_pi = ((aver_pi * i) + sum_pi / num_procs) / (i + 1);
+                printf("ROUND %d, the value of PI is %.15f\n", i, aver_pi);
+            }
         }
     }
+    stop = MPI_Wtime();
+    printThroughput(stats, proc_name, rank_id, num_procs);
 
     if(rank_id == 0) {
-        stop = MPI_Wtime();
         printf("\nThe final value of PI is %.15f\n", aver_pi);
         printf("The real value of PI is %.15f\n", PI);
         printf("Total running time: %f\n", stop - start);
@@ -82,4 +204,4 @@ int main(int argc, char* argv[]) {
     }
     MPI_Finalize();
     return 0;
-}
\ No newline at end of file
+}
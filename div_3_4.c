@@ -2,7 +2,7 @@
  * DESCRIPTION: A program to find the numbers between 1-1000 which can be divisible by 3 or 4 using pthreads and semaphore
  *
  * Author: Kejie Zhang
- * LAST UPDATED: 02/13/2019
+ * LAST UPDATED: 10/18/2026
  *
  * USAGE: gcc -O3 div_3_4.c -o div_3_4 -pthread
  * USEFUL REFERENCE:
@@ -17,46 +17,30 @@
 
 
 #define MAX_NUM 1000
-sem_t sem1, sem2, sem3, sem4;
+#define NUM_THREADS 4
+sem_t sems[NUM_THREADS];
 int x;
 
-void *f1(void *p) {
-    int i;
-    bool div_3 = false, div_4 = false;
-    for (i = 1; i <= MAX_NUM / 4; i++) {
-        sem_wait(&sem1);
-        if(i % 3 == 0) {
-            div_3 = true;
-        }
-        if(i % 4 == 0) {
-            div_4 = true;
-        }
+struct thread_data {
+    int id;
+    int lo;
+    int hi;
+};
 
-        if(div_3) {
-            if(div_4) {
-                x++;
-                printf("\n%d is divisible by 3 and 4", i);
-            } else {
-                x++;
-                printf("\n%d is divisible by 3", i);
-            }
-        } else if (div_4) {
-            x++;
-            printf("\n%d is divisible by 4", i);
-        } else {
-            printf("\n%d is not divisible by 3 or 4", i);
-        }
-        div_3 = false;
-        div_4 = false;
-        sem_post(&sem2);
-    }
-}
-
-void *f2(void *p) {
+/**
+ * Check the integers in [lo, hi] in turn with the next thread, using a ring of semaphores.
+ * See div_wheel.c for the generalized and parallel version.
+ * @param p
+ * @return
+ */
+void *worker(void *p) {
+    int id = ((struct thread_data *) p)->id;
+    int lo = ((struct thread_data *) p)->lo;
+    int hi = ((struct thread_data *) p)->hi;
     int i;
     bool div_3 = false, div_4 = false;
-    for (i = MAX_NUM / 4 + 1; i <= MAX_NUM / 2; i++) {
-        sem_wait(&sem2);
+    for (i = lo; i <= hi; i++) {
+        sem_wait(&sems[id]);
         if(i % 3 == 0) {
             div_3 = true;
         }
@@ -80,92 +64,31 @@ void *f2(void *p) {
         }
         div_3 = false;
         div_4 = false;
-        sem_post(&sem3);
+        sem_post(&sems[(id + 1) % NUM_THREADS]);
     }
+    return NULL;
 }
 
-void *f3(void *p) {
-    int i;
-    bool div_3 = false, div_4 = false;
-    for (i = MAX_NUM / 2 + 1; i <= MAX_NUM - MAX_NUM / 4; i++) {
-        sem_wait(&sem3);
-        if(i % 3 == 0) {
-            div_3 = true;
-        }
-        if(i % 4 == 0) {
-            div_4 = true;
-        }
 
-        if(div_3) {
-            if(div_4) {
-                x++;
-                printf("\n%d is divisible by 3 and 4", i);
-            } else {
-                x++;
-                printf("\n%d is divisible by 3", i);
-            }
-        } else if (div_4) {
-            x++;
-            printf("\n%d is divisible by 4", i);
-        } else {
-            printf("\n%d is not divisible by 3 or 4", i);
-        }
-        div_3 = false;
-        div_4 = false;
-        sem_post(&sem4);
-    }
-}
-
-void *f4(void *p) {
+int main() {
+    pthread_t workers[NUM_THREADS];
+    struct thread_data thread_data_array[NUM_THREADS];
     int i;
-    bool div_3 = false, div_4 = false;
-    for (i = MAX_NUM - MAX_NUM / 4 + 1; i <= MAX_NUM; i++) {
-        sem_wait(&sem4);
-        if(i % 3 == 0) {
-            div_3 = true;
-        }
-        if(i % 4 == 0) {
-            div_4 = true;
-        }
+    x = 0;
 
-        if(div_3) {
-            if(div_4) {
-                x++;
-                printf("\n%d is divisible by 3 and 4", i);
-            } else {
-                x++;
-                printf("\n%d is divisible by 3", i);
-            }
-        } else if (div_4) {
-            x++;
-            printf("\n%d is divisible by 4", i);
-        } else {
-            printf("\n%d is not divisible by 3 or 4", i);
-        }
-        div_3 = false;
-        div_4 = false;
-        sem_post(&sem1);
+    /** Each thread owns a contiguous quarter and the first one starts */
+    for (i = 0; i < NUM_THREADS; i++) {
+        sem_init(&sems[i], 0, i == 0 ? 1 : 0);
+        thread_data_array[i].id = i;
+        thread_data_array[i].lo = MAX_NUM / NUM_THREADS * i + 1;
+        thread_data_array[i].hi = i == NUM_THREADS - 1 ? MAX_NUM : MAX_NUM / NUM_THREADS * (i + 1);
     }
-}
 
-
-int main() {
-    pthread_t p1, p2, p3, p4;
-    x = 0;
-    sem_init(&sem1, 0, 1);
-    sem_init(&sem2, 0, 0);
-    sem_init(&sem3, 0, 0);
-    sem_init(&sem4, 0, 0);
-
-    pthread_create(&p1, NULL, f1, (void *) NULL);
-    pthread_create(&p2, NULL, f2, (void *) NULL);
-    pthread_create(&p3, NULL, f3, (void *) NULL);
-    pthread_create(&p4, NULL, f4, (void *) NULL);
-    pthread_join(p1, NULL);
-    pthread_join(p2, NULL);
-    pthread_join(p3, NULL);
-    pthread_join(p4, NULL);
+    for (i = 0; i < NUM_THREADS; i++)
+        pthread_create(&workers[i], NULL, worker, (void *) &thread_data_array[i]);
+    for (i = 0; i < NUM_THREADS; i++)
+        pthread_join(workers[i], NULL);
     printf("\n x = %d\n", x);
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,158 @@
+/**********************************
+ * DESCRIPTION: A generalized version of div_3_4.c. Counts and enumerates the integers in [1, N]
+ * which are divisible by any (or all) of an arbitrary set of divisors, using a periodic bitmask
+ * (wheel) over the LCM of the divisors, popcount and OpenMP.
+ *
+ * The residues modulo P = lcm(lcm(divisors), 64) are precomputed once as a bit pattern of P / 64
+ * words. Because P is a multiple of 64, the word holding the integers [64k, 64k + 63] is always
+ * pattern word (k mod P / 64), so a range is counted with one popcount per 64 integers and no
+ * division at all. Counting uses whole periods plus a partial one, enumeration scans the words
+ * of each segment in parallel. The wheel is in div_wheel.h, which benchmark.cpp also runs.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   COMPILE: gcc -O3 -march=native -fopenmp div_wheel.c -o div_wheel
+ *   RUN: ./div_wheel [-n N] [-a] [-p K] [divisor ...]
+ *     -n N   upper bound of the range [1, N], accepts 1e10 style (default 1000)
+ *     -a     count the integers divisible by all divisors instead of any
+ *     -p K   print the first K matches
+ *     divisors default to 3 4, which reproduces the result of div_3_4.c
+ *
+ * USEFUL REFERENCE:
+ *    -> Wheel factorization: https://en.wikipedia.org/wiki/Wheel_factorization
+ *    -> OpenMP: https://computing.llnl.gov/tutorials/openMP/
+**********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <omp.h>
+#include "div_wheel.h"
+
+#define MAX_DIVISORS 64
+#define BRUTE_FORCE_LIMIT 100000000ULL
+
+double CLOCK() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/**
+ * Reference count with one modulo per divisor and integer
+ * @param n
+ * @param divisors
+ * @param num_divisors
+ * @param all
+ * @return
+ */
+uint64_t brute_force_count(uint64_t n, const uint64_t divisors[], int num_divisors, bool all) {
+    uint64_t i, count = 0;
+#pragma omp parallel for schedule(static) reduction(+:count)
+    for (i = 1; i <= n; i++) {
+        int hits = 0, j;
+        for (j = 0; j < num_divisors; j++)
+            hits += i % divisors[j] == 0;
+        count += all ? hits == num_divisors : hits > 0;
+    }
+    return count;
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t divisors[MAX_DIVISORS] = {3, 4};
+    uint64_t n = 1000, to_print = 0, count, scanned, brute, i;
+    int num_divisors = 2, opt;
+    bool all = false;
+    double start, stop;
+    wheel_t wheel;
+
+    while ((opt = getopt(argc, argv, "n:ap:")) != -1) {
+        switch (opt) {
+            case 'n':
+                n = (uint64_t) strtod(optarg, NULL);
+                break;
+            case 'a':
+                all = true;
+                break;
+            case 'p':
+                to_print = strtoull(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n N] [-a] [-p K] [divisor ...]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (optind < argc) {
+        num_divisors = 0;
+        for (; optind < argc && num_divisors < MAX_DIVISORS; optind++) {
+            divisors[num_divisors] = strtoull(argv[optind], NULL, 10);
+            if (divisors[num_divisors] == 0) {
+                fprintf(stderr, "Divisors must be positive integers\n");
+                return 1;
+            }
+            num_divisors++;
+        }
+    }
+
+    printf("Building the wheel...");
+    start = CLOCK();
+    if (wheel_init(&wheel, divisors, num_divisors, all) != 0) {
+        printf("[FAILED]\nThe lcm of the divisors exceeds the wheel limit of %llu bits\n",
+               (unsigned long long) MAX_WHEEL_BITS);
+        return 1;
+    }
+    stop = CLOCK();
+    printf("[DONE]\nWheel period %llu (%llu words, %llu matches per period) in %f s\n",
+           (unsigned long long) wheel.period, (unsigned long long) wheel.words,
+           (unsigned long long) wheel.per_period, stop - start);
+
+    /** Integers are counted from 1 like div_3_4.c, so drop the match at 0 */
+    start = CLOCK();
+    count = wheel_count_below(&wheel, n + 1) - wheel_count_below(&wheel, 1);
+    stop = CLOCK();
+    printf("Integers in [1, %llu] divisible by %s of the divisors: %llu (%f s)\n",
+           (unsigned long long) n, all ? "all" : "any", (unsigned long long) count, stop - start);
+
+    start = CLOCK();
+    scanned = wheel_count_scan(&wheel, 1, n + 1);
+    stop = CLOCK();
+    printf("Parallel scan with %d threads: %llu (%f s, %.2f G integers/s)\n",
+           omp_get_max_threads(), (unsigned long long) scanned, stop - start,
+           n / (stop - start) * 1e-9);
+
+    if (n <= BRUTE_FORCE_LIMIT) {
+        start = CLOCK();
+        brute = brute_force_count(n, divisors, num_divisors, all);
+        stop = CLOCK();
+        printf("Brute force: %llu (%f s)\n", (unsigned long long) brute, stop - start);
+        printf("Checking the calculation result...%s\n",
+               brute == count && scanned == count ? "[CORRECT]" : "[WRONG]");
+    } else {
+        printf("Checking the calculation result...%s\n", scanned == count ? "[CORRECT]" : "[WRONG]");
+    }
+
+    if (to_print > 0) {
+        uint64_t hi = n + 1, *matches;
+
+        /** Only enumerate the range which holds the first K matches */
+        if (wheel.per_period > 0 && to_print < count) {
+            uint64_t periods = (to_print + wheel.per_period - 1) / wheel.per_period;
+            if (periods * wheel.period < hi)
+                hi = periods * wheel.period + 1;
+        }
+        matches = malloc((wheel_count_below(&wheel, hi) + 1) * sizeof(uint64_t));
+        count = wheel_enumerate(&wheel, 1, hi, matches);
+        for (i = 0; i < count && i < to_print; i++)
+            printf("%llu%c", (unsigned long long) matches[i], (i + 1) % 10 == 0 ? '\n' : '\t');
+        printf("\n");
+        free(matches);
+    }
+
+    wheel_free(&wheel);
+    return 0;
+}
@@ -0,0 +1,218 @@
+/**********************************
+ * DESCRIPTION: The wheel of div_wheel.c: counts and enumerates the integers divisible by any
+ * (or all) of a set of divisors with a periodic bitmask over the LCM of the divisors, popcount
+ * and OpenMP. Shared by div_wheel.c and the div_wheel kernel of benchmark.cpp.
+ *
+ * The residues modulo P = lcm(lcm(divisors), 64) are precomputed once as a bit pattern of P / 64
+ * words. Because P is a multiple of 64, the word holding the integers [64k, 64k + 63] is always
+ * pattern word (k mod P / 64), so a range is counted with one popcount per 64 integers and no
+ * division at all.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   wheel_t w;
+ *   uint64_t divisors[] = {3, 4};
+ *   if (wheel_init(&w, divisors, 2, false) == 0) {
+ *       uint64_t count = wheel_count_below(&w, n + 1) - wheel_count_below(&w, 1);
+ *       wheel_free(&w);
+ *   }
+ *
+ * USEFUL REFERENCE:
+ *    -> Wheel factorization: https://en.wikipedia.org/wiki/Wheel_factorization
+**********************************/
+#ifndef DIV_WHEEL_H
+#define DIV_WHEEL_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MAX_WHEEL_BITS (1ULL << 32)
+#define SEGMENT_WORDS (1 << 14)
+
+typedef struct {
+    uint64_t period;      /* lcm(lcm(divisors), 64), a multiple of 64 */
+    uint64_t words;       /* period / 64 */
+    uint64_t per_period;  /* number of matches in one period */
+    uint64_t *bits;       /* bit r is set iff residue r (mod period) is a match */
+    uint64_t *prefix;     /* prefix[k] = number of matches in words [0, k) */
+} wheel_t;
+
+static inline uint64_t wheel_gcd(uint64_t a, uint64_t b) {
+    while (b) {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+ * lcm which reports 0 once the result exceeds the wheel limit
+ * @param a
+ * @param b
+ * @return
+ */
+static inline uint64_t wheel_lcm(uint64_t a, uint64_t b) {
+    uint64_t q = a / wheel_gcd(a, b);
+    if (q > MAX_WHEEL_BITS / b)
+        return 0;
+    return q * b;
+}
+
+/**
+ * Build the wheel of residues matching the divisors
+ * @param w
+ * @param divisors
+ * @param num_divisors
+ * @param all  match the residues divisible by every divisor instead of any
+ * @return 0 on success
+ */
+static inline int wheel_init(wheel_t *w, const uint64_t divisors[], int num_divisors, bool all) {
+    uint64_t period = 64, k, d;
+    int i;
+
+    for (i = 0; i < num_divisors; i++) {
+        period = wheel_lcm(period, divisors[i]);
+        if (period == 0)
+            return -1;
+    }
+
+    w->period = period;
+    w->words = period / 64;
+    w->bits = (uint64_t *) calloc(w->words, sizeof(uint64_t));
+    w->prefix = (uint64_t *) malloc((w->words + 1) * sizeof(uint64_t));
+    if (w->bits == NULL || w->prefix == NULL)
+        return -1;
+
+    /** Sieve the residues: "any" sets the multiples of each divisor, "all" the multiples of their lcm */
+    if (all) {
+        d = 1;
+        for (i = 0; i < num_divisors; i++)
+            d = wheel_lcm(d, divisors[i]);
+        for (k = 0; k < period; k += d)
+            w->bits[k >> 6] |= 1ULL << (k & 63);
+    } else {
+        for (i = 0; i < num_divisors; i++) {
+            d = divisors[i];
+            for (k = 0; k < period; k += d)
+                w->bits[k >> 6] |= 1ULL << (k & 63);
+        }
+    }
+
+    w->prefix[0] = 0;
+    for (k = 0; k < w->words; k++)
+        w->prefix[k + 1] = w->prefix[k] + __builtin_popcountll(w->bits[k]);
+    w->per_period = w->prefix[w->words];
+    return 0;
+}
+
+static inline void wheel_free(wheel_t *w) {
+    free(w->bits);
+    free(w->prefix);
+}
+
+/**
+ * Number of matches among the integers [0, n) in O(1)
+ * @param w
+ * @param n
+ * @return
+ */
+static inline uint64_t wheel_count_below(const wheel_t *w, uint64_t n) {
+    uint64_t word = n >> 6, tail = n & 63;
+    uint64_t count = (word / w->words) * w->per_period + w->prefix[word % w->words];
+    if (tail)
+        count += __builtin_popcountll(w->bits[word % w->words] & ((1ULL << tail) - 1));
+    return count;
+}
+
+/**
+ * Number of matches among the integers [lo, hi) by scanning one word per 64 integers, in parallel
+ * over segments. This is what the enumeration pays per integer and is kept as a throughput check
+ * of wheel_count_below.
+ * @param w
+ * @param lo
+ * @param hi
+ * @return
+ */
+static inline uint64_t wheel_count_scan(const wheel_t *w, uint64_t lo, uint64_t hi) {
+    uint64_t first = lo >> 6, last = hi >> 6, count = 0;
+    int64_t seg, num_segs;
+
+    if (lo >= hi)
+        return 0;
+
+    num_segs = (int64_t) ((last - first) / SEGMENT_WORDS + 1);
+#pragma omp parallel for schedule(static) reduction(+:count)
+    for (seg = 0; seg < num_segs; seg++) {
+        uint64_t begin = first + (uint64_t) seg * SEGMENT_WORDS;
+        uint64_t end = begin + SEGMENT_WORDS < last ? begin + SEGMENT_WORDS : last;
+        uint64_t k = begin % w->words;
+
+        /** Split the segment into runs which are contiguous in the pattern so they vectorize */
+        while (begin < end) {
+            uint64_t run = w->words - k < end - begin ? w->words - k : end - begin;
+            const uint64_t *p = w->bits + k;
+            uint64_t j, sum = 0;
+#pragma omp simd reduction(+:sum)
+            for (j = 0; j < run; j++)
+                sum += __builtin_popcountll(p[j]);
+            count += sum;
+            begin += run;
+            k = 0;
+        }
+    }
+
+    /** Trim the partial words at both ends */
+    if (lo & 63)
+        count -= __builtin_popcountll(w->bits[first % w->words] & ((1ULL << (lo & 63)) - 1));
+    if (hi & 63)
+        count += __builtin_popcountll(w->bits[last % w->words] & ((1ULL << (hi & 63)) - 1));
+    return count;
+}
+
+/**
+ * Write the matches among the integers [lo, hi) in increasing order. Each segment is counted in
+ * O(1) first so that every thread knows where its matches start in the output.
+ * @param w
+ * @param lo
+ * @param hi
+ * @param out  room for wheel_count_below(w, hi) - wheel_count_below(w, lo) values
+ * @return the number of matches written
+ */
+static inline uint64_t wheel_enumerate(const wheel_t *w, uint64_t lo, uint64_t hi, uint64_t out[]) {
+    uint64_t base = wheel_count_below(w, lo);
+    uint64_t span = 64ULL * SEGMENT_WORDS;
+    int64_t seg, num_segs;
+
+    if (lo >= hi)
+        return 0;
+
+    num_segs = (int64_t) ((hi - lo + span - 1) / span);
+#pragma omp parallel for schedule(dynamic, 4)
+    for (seg = 0; seg < num_segs; seg++) {
+        uint64_t begin = lo + (uint64_t) seg * span;
+        uint64_t end = hi - begin > span ? begin + span : hi;
+        uint64_t *dst = out + (wheel_count_below(w, begin) - base);
+        uint64_t n = begin;
+
+        while (n < end) {
+            uint64_t word = w->bits[(n >> 6) % w->words] >> (n & 63);
+            uint64_t width = 64 - (n & 63);
+            if (end - n < width) {
+                width = end - n;
+                word &= (1ULL << width) - 1;
+            }
+            while (word) {
+                *dst++ = n + __builtin_ctzll(word);
+                word &= word - 1;
+            }
+            n += width;
+        }
+    }
+    return wheel_count_below(w, hi) - base;
+}
+
+#endif
@@ -1,12 +1,35 @@
 /**********************************
  * DESCRIPTION: A program to calculate histogram using MPI
  *
+ * Question [3] also computes the cumulative distribution and answers quantile queries from
+ * the same pass: the bins are reduce-scattered so every rank owns a block of them, each
+ * rank scans its block with OpenMP threads (block sums, scan of the block sums, then each
+ * thread scans its block from its offset), MPI_Exscan adds the counts of the ranks before,
+ * and every quantile is found by binary search in the rank whose block holds it.
+ *
+ * Question [4] needs neither the value range nor bins: every thread streams its values into
+ * a t-digest (quantile_sketch.h) of fixed size, the threads' sketches are merged per rank,
+ * and the ranks' sketches are merged by MPI_Reduce with a custom operation on a contiguous
+ * byte type.
+ *
+ * Question [5] is question [1] with one set of bins per node instead of per rank: the ranks
+ * of a node (MPI_Comm_split_type with MPI_COMM_TYPE_SHARED) count their values straight into
+ * one array of an MPI-3 shared-memory window with atomic adds, and only one leader per node
+ * takes part in the MPI_Reduce across the nodes. A node holds num_bins integers instead of
+ * two arrays of them per rank, only world rank 0 allocates the result, and the reduction
+ * moves num_bins integers per node instead of per rank. The price is an atomic add per
+ * value, contended when there are few bins.
+ *
+ * With -f the data is read from a CSV or text file by csv_reader.h instead of generated, the
+ * values rounded to integers and clamped to [MIN_RANGE, MAX_RANGE].
+ *
  * Author: Kejie Zhang
- * LAST UPDATED: 03/25/2019
+ * LAST UPDATED: 10/18/2026
  *
  * USAGE:
- *   COMPILE: mpicxx -std=c++11 histogram.cpp -o histogram
- *   RUN: mpiexec -n < 4 or 8 > ./histogram
+ *   COMPILE: mpicxx -std=c++17 -fopenmp histogram.cpp -o histogram
+ *   RUN: mpiexec -n < 4 or 8 > ./histogram [-f data.csv] [quantile ...]
+ *   The quantiles of questions [3] and [4] default to 0.5 0.9 0.99 0.999.
  *
  * USEFUL REFERENCE:
  *    -> MPI: https://computing.llnl.gov/tutorials/mpi/
@@ -14,7 +37,18 @@
 #include <iostream>
 #include <vector>
 #include <random>
+#include <algorithm>
+#include <cmath>
+#include <climits>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <omp.h>
 #include <mpi.h>
+#include "quantile_sketch.h"
+#include "csv_reader.h"
+#include "histogram.h"
 
 #define MIN_RANGE 1
 #define MAX_RANGE 1000
@@ -28,7 +62,10 @@ void setLocalData(
         int local_data[],
         int num_data,
         int local_num_data,
-        int rank_id);
+        int rank_id,
+        int flag);
+
+int readData(const char *path, vector<int> &values);
 
 void setLocalBins(
         int bins[],
@@ -51,12 +88,29 @@ void histogram2(
         int local_data[],
         int local_bins[],
         int local_num_data,
-        int local_num_bins,
+        int block_bins,
         int num_bins,
         int rank_id);
 
 void printResult(int bins[], int length);
 
+void prefixSum(const int counts[], long cdf[], int length, long offset);
+
+void quantiles(
+        int local_bins[],
+        int num_bins,
+        int num_procs,
+        int rank_id,
+        const vector<double> &queries);
+
+void sketchQuantiles(
+        int local_data[],
+        int local_num_data,
+        int rank_id,
+        const vector<double> &queries);
+
+void nodeHistogram(int local_data[], int local_num_data, int bins[], int num_bins, int rank_id);
+
 int main(int argc, char *argv[]) {
     /** Variables */
     int rank_id,
@@ -67,63 +121,117 @@ int main(int argc, char *argv[]) {
             num_bins,
             local_num_data,
             local_num_bins,
-            question;
+            question,
+            opt;
     double start,
             stop;
+    vector<double> queries;
+    vector<int> file_data;
+    const char *path = NULL;
 
-    MPI_Init(&argc, &argv);
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &i);
     MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank_id);
 
+    while ((opt = getopt(argc, argv, "f:")) != -1) {
+        if (opt == 'f')
+            path = optarg;
+    }
+    for (i = optind; i < argc; i++)
+        queries.push_back(atof(argv[i]));
+    if (queries.empty())
+        queries = {0.5, 0.9, 0.99, 0.999};
+
     /** Get the input */
     if (rank_id == 0) {
-        cout << "Please choose which question? [1] or [2]?" << endl;
+        cout << "Please choose which question? [1], [2], [3] (with quantiles), [4] (sketch) or [5] (node-shared bins)?" << endl;
         cin >> question;
-        cout << "Please input the number of data:" << endl;
-        cin >> num_data;
-        cout << "Please input the number of bins(classes):" << endl;
-        cin >> num_bins;
+        if (path == NULL) {
+            cout << "Please input the number of data:" << endl;
+            cin >> num_data;
+        } else if (readData(path, file_data) == CSV_OK) {
+            num_data = (int) file_data.size();
+        } else {
+            num_data = 0;
+            num_bins = 0;
+            question = 0;
+        }
+        if (question == 4) {
+            num_bins = num_procs;
+        } else if (question != 0) {
+            cout << "Please input the number of bins(classes):" << endl;
+            cin >> num_bins;
+        }
 
         local_num_data = num_data / num_procs;
         num_data = local_num_data * num_procs;
+        if (path != NULL && question != 0 && num_data < (int) file_data.size())
+            cout << "Using the first " << num_data << " values, a multiple of the number of ranks" << endl;
 
         local_num_bins = num_bins / num_procs;
         num_bins = local_num_bins * num_procs;
 
-        if(question == 1) {
+        if(question == 1 || question == 3 || question == 4 || question == 5) {
             local_num_bins = num_bins;
         } else if (question == 2) {
             local_num_data = num_data;
             local_num_bins = num_bins;
         } else {
-            return -1;
+            question = 0;
         }
     }
+    MPI_Bcast(&question, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (question == 0) {
+        MPI_Finalize();
+        return -1;
+    }
     MPI_Bcast(&num_data, 1, MPI_INT, 0, MPI_COMM_WORLD);
     MPI_Bcast(&num_bins, 1, MPI_INT, 0, MPI_COMM_WORLD);
     MPI_Bcast(&local_num_data, 1, MPI_INT, 0, MPI_COMM_WORLD);
     MPI_Bcast(&local_num_bins, 1, MPI_INT, 0, MPI_COMM_WORLD);
 
-    /** Populate the random data */
-    int* data = new int[num_data];
-    int* bins = new int[num_bins];
+    /** Populate the random data; question 5 keeps the bins in the node's shared window */
+    int* data = rank_id == 0 ? new int[num_data] : NULL;
+    int* bins = question != 5 || rank_id == 0 ? new int[num_bins] : NULL;
     int* local_data = new int[local_num_data];
-    int* local_bins = new int[local_num_bins];
+    int* local_bins = question != 5 ? new int[local_num_bins] : NULL;
+
+    if (rank_id == 0 && path != NULL)
+        copy(file_data.begin(), file_data.begin() + num_data, data);
 
     /** Start the core components*/
     start = MPI_Wtime();
-    setLocalData(data, local_data, num_data, local_num_data, rank_id);
+    setLocalData(data, local_data, num_data, local_num_data, rank_id, path == NULL);
 //    printArray(local_data, local_num_data);
-    setLocalBins(bins, local_bins, local_num_bins);
-//    histogram(data, bins, local_data, local_bins, local_num_data, local_num_bins);
-    histogram2(data, bins, local_data, local_bins, local_num_data, local_num_bins, num_bins, rank_id);
-//    printArray(local_bins, local_num_bins);
-    MPI_Reduce(local_bins, bins, num_bins, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (question == 4) {
+        sketchQuantiles(local_data, local_num_data, rank_id, queries);
+        if (rank_id == 0)
+            cout << "Total running time is: " << MPI_Wtime() - start << endl;
+        MPI_Finalize();
+        return 0;
+    }
+    if (question == 5) {
+        nodeHistogram(local_data, local_num_data, bins, num_bins, rank_id);
+    } else {
+        setLocalBins(bins, local_bins, local_num_bins);
+        if (question == 2)
+            histogram2(data, bins, local_data, local_bins, local_num_data, num_bins / num_procs, num_bins, rank_id);
+        else
+            histogram(data, bins, local_data, local_bins, local_num_data, local_num_bins);
+//        printArray(local_bins, local_num_bins);
+        MPI_Reduce(local_bins, bins, num_bins, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+    }
     if(rank_id == 0) {
         stop = MPI_Wtime();
         printResult(bins, num_bins);
         cout << "Total running time is: " << stop - start << endl;
     }
+    if (question == 3) {
+        start = MPI_Wtime();
+        quantiles(local_bins, num_bins, num_procs, rank_id, queries);
+        if (rank_id == 0)
+            cout << "Quantile running time is: " << MPI_Wtime() - start << endl;
+    }
 
     /** Clean */
     MPI_Finalize();
@@ -182,29 +290,69 @@ void printArray(int data[], int length) {
  * @param data
  * @param local_data
  * @param local_num_data
- * @param flag
+ * @param flag  1 to populate data randomly, 0 when rank 0 already holds it
  */
 void setLocalData(
         int data[],
         int local_data[],
         int num_data,
         int local_num_data,
-        int rank_id) {
-    if (rank_id == 0) {
+        int rank_id,
+        int flag) {
+    if (rank_id == 0 && flag == 1) {
         populateVectorRandom(data, num_data, MIN_RANGE, MAX_RANGE, 1);
     }
-    MPI_Scatter(
-            data,
-            local_num_data,
-            MPI_INT,
-            local_data,
-            local_num_data,
-            MPI_INT,
-            0,
-            MPI_COMM_WORLD);
+    /** Question 2: every rank sees all the data */
+    if (local_num_data == num_data) {
+        if (rank_id == 0)
+            copy(data, data + num_data, local_data);
+        MPI_Bcast(local_data, num_data, MPI_INT, 0, MPI_COMM_WORLD);
+    } else {
+        MPI_Scatter(
+                data,
+                local_num_data,
+                MPI_INT,
+                local_data,
+                local_num_data,
+                MPI_INT,
+                0,
+                MPI_COMM_WORLD);
+    }
     if(rank_id == 0) {
-        free(data);
+        delete[] data;
+    }
+}
+
+/**
+ * Read the data of rank 0 from a file, rounded to integers and clamped to the range
+ * @param path
+ * @param values
+ * @return CSV_OK or a CSV_* error code
+ */
+int readData(const char *path, vector<int> &values) {
+    vector<double> numbers;
+    struct stat st;
+    long clamped = 0;
+    double start = MPI_Wtime();
+
+    int rc = csv_read(path, numbers);
+    if (rc != CSV_OK || numbers.size() > (size_t) INT_MAX) {
+        cout << "Cannot read the numbers of " << path << " (error " << rc << ")" << endl;
+        return rc != CSV_OK ? rc : CSV_PARSE;
     }
+    double time = MPI_Wtime() - start;
+    stat(path, &st);
+
+    values.resize(numbers.size());
+#pragma omp parallel for reduction(+:clamped)
+    for (size_t i = 0; i < numbers.size(); i++) {
+        double v = numbers[i] >= MIN_RANGE ? min(numbers[i], (double) MAX_RANGE) : MIN_RANGE;
+        clamped += v != numbers[i];
+        values[i] = (int) lround(v);
+    }
+    printf("Read %zu values from %s in %.3f s (%.2f GB/s), %ld clamped to [%d, %d]\n", numbers.size(), path,
+           time, st.st_size / time * 1e-9, clamped, MIN_RANGE, MAX_RANGE);
+    return CSV_OK;
 }
 
 /**
@@ -244,20 +392,9 @@ void histogram(
         int local_num_data,
         int local_num_bins) {
 
-    int range,
-            bin;
-
-    if((MAX_RANGE - MIN_RANGE + 1) % local_num_bins != 0) {
-        range = (MAX_RANGE - MIN_RANGE + 1) / local_num_bins + 1;
-    } else {
-        range = (MAX_RANGE - MIN_RANGE + 1) / local_num_bins;
-    }
-
-    for(int i = 0; i < local_num_data; i++) {
-        bin = (local_data[i] - MIN_RANGE) / range;
-        local_bins[bin]++;
-    }
+    int range = histogram_range(MIN_RANGE, MAX_RANGE, local_num_bins);
 
+    histogram_count(local_data, local_num_data, MIN_RANGE, range, local_bins);
 }
 
 /**
@@ -267,7 +404,8 @@ void histogram(
  * @param local_data
  * @param local_bins
  * @param local_num_data
- * @param local_num_bins
+ * @param block_bins  bins counted by each rank
+ * @param num_bins
  * @param rank_id
  */
 void histogram2(
@@ -276,23 +414,18 @@ void histogram2(
         int local_data[],
         int local_bins[],
         int local_num_data,
-        int local_num_bins,
+        int block_bins,
         int num_bins,
         int rank_id) {
 
-    int range,
+    int range = histogram_range(MIN_RANGE, MAX_RANGE, num_bins),
             bin,
             lo,
             hi;
 
-    if((MAX_RANGE - MIN_RANGE + 1) % num_bins != 0) {
-        range = (MAX_RANGE - MIN_RANGE + 1) / num_bins + 1;
-    } else {
-        range = (MAX_RANGE - MIN_RANGE + 1) / num_bins;
-    }
-
-    lo = range * local_num_bins * rank_id + MIN_RANGE;
-    hi = range * local_num_bins * (rank_id+1) - 1 + MIN_RANGE;
+    /** Each rank counts its own block of the bins, lo and hi relative to MIN_RANGE like temp */
+    lo = range * block_bins * rank_id;
+    hi = range * block_bins * (rank_id+1) - 1;
 
     for(int i = 0; i < local_num_data; i++) {
         int temp = local_data[i] - MIN_RANGE;
@@ -310,13 +443,7 @@ void histogram2(
  */
 void printResult(int bins[], int length) {
 
-    int range;
-
-    if((MAX_RANGE - MIN_RANGE + 1) % length != 0) {
-        range = (MAX_RANGE - MIN_RANGE + 1) / length + 1;
-    } else {
-        range = (MAX_RANGE - MIN_RANGE + 1) / length;
-    }
+    int range = histogram_range(MIN_RANGE, MAX_RANGE, length);
 
     for(int i = 0; i < length; i++) {
         cout << "[" << (range * i + MIN_RANGE)
@@ -324,3 +451,216 @@ void printResult(int bins[], int length) {
              << "]: " << bins[i] << endl;
     }
 }
+
+/**
+ * Inclusive prefix sum of counts into cdf, starting from offset, work-efficient over the
+ * threads: each thread sums its block, the block sums are scanned, and each thread scans
+ * its block from its offset
+ * @param counts
+ * @param cdf
+ * @param length
+ * @param offset
+ */
+void prefixSum(const int counts[], long cdf[], int length, long offset) {
+    vector<long> block_sums;
+
+#pragma omp parallel
+    {
+        int t = omp_get_thread_num(),
+                num_threads = omp_get_num_threads(),
+                lo = (int) ((long) length * t / num_threads),
+                hi = (int) ((long) length * (t + 1) / num_threads);
+        long sum = 0;
+
+#pragma omp single
+        block_sums.assign(num_threads + 1, 0);
+
+        for (int i = lo; i < hi; i++)
+            sum += counts[i];
+        block_sums[t + 1] = sum;
+#pragma omp barrier
+
+#pragma omp single
+        for (int s = 1; s <= num_threads; s++)
+            block_sums[s] += block_sums[s - 1];
+
+        sum = offset + block_sums[t];
+        for (int i = lo; i < hi; i++) {
+            sum += counts[i];
+            cdf[i] = sum;
+        }
+    }
+}
+
+/**
+ * Cumulative distribution of the bins and quantile queries on it, for question 3
+ * @param local_bins  the full histogram of this rank's data
+ * @param num_bins
+ * @param num_procs
+ * @param rank_id
+ * @param queries     quantiles in [0, 1]
+ */
+void quantiles(
+        int local_bins[],
+        int num_bins,
+        int num_procs,
+        int rank_id,
+        const vector<double> &queries) {
+
+    int range = histogram_range(MIN_RANGE, MAX_RANGE, num_bins),
+            owned = num_bins / num_procs,
+            num_queries = (int) queries.size();
+    long rank_total = 0,
+            offset = 0,
+            total = 0;
+    vector<int> counts(owned);
+    vector<long> cdf(owned);
+    vector<double> values(num_queries, INFINITY), result(num_queries);
+
+    /** Rank r owns the global counts of bins [r * owned, (r + 1) * owned) */
+    MPI_Reduce_scatter_block(local_bins, counts.data(), owned, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    for (int i = 0; i < owned; i++)
+        rank_total += counts[i];
+    MPI_Exscan(&rank_total, &offset, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+    if (rank_id == 0)
+        offset = 0;
+    MPI_Allreduce(&rank_total, &total, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+    prefixSum(counts.data(), cdf.data(), owned, offset);
+
+    /** The rank holding the target rank of a quantile interpolates it inside its bin */
+    for (int q = 0; q < num_queries; q++) {
+        long target = max(1L, (long) ceil(min(max(queries[q], 0.0), 1.0) * total));
+        if (total == 0 || target <= offset || target > offset + rank_total)
+            continue;
+        int bin = (int) (lower_bound(cdf.begin(), cdf.end(), target) - cdf.begin());
+        long before = bin > 0 ? cdf[bin - 1] : offset;
+        int global_bin = rank_id * owned + bin;
+        values[q] = max(MIN_RANGE + range * global_bin + range * (double) (target - before) / counts[bin] - 1,
+                        (double) (MIN_RANGE + range * global_bin));
+        values[q] = min(values[q], (double) MAX_RANGE);
+    }
+    MPI_Reduce(values.data(), result.data(), num_queries, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+
+    if (rank_id == 0) {
+        cout << "Quantiles of " << total << " values:" << endl;
+        for (int q = 0; q < num_queries; q++) {
+            if (std::isinf(result[q])) {
+                printf("p%-8g -\n", queries[q] * 100);
+                continue;
+            }
+            int bin = (int) ((result[q] - MIN_RANGE) / range);
+            printf("p%-8g %10.2f   in [%d - %d]\n", queries[q] * 100, result[q],
+                   range * bin + MIN_RANGE, range * (bin + 1) - 1 + MIN_RANGE);
+        }
+    }
+}
+
+/**
+ * MPI reduction merging sketches, in into inout
+ */
+void sketchReduce(void *in, void *inout, int *len, MPI_Datatype *type) {
+    QuantileSketch *a = (QuantileSketch *) in,
+            *b = (QuantileSketch *) inout;
+    for (int i = 0; i < *len; i++)
+        sketch_merge(b[i], a[i]);
+}
+
+/**
+ * Quantiles from a streaming sketch per thread, merged per rank and across ranks, for question 4
+ * @param local_data
+ * @param local_num_data
+ * @param rank_id
+ * @param queries  quantiles in [0, 1]
+ */
+void sketchQuantiles(
+        int local_data[],
+        int local_num_data,
+        int rank_id,
+        const vector<double> &queries) {
+
+    QuantileSketch *local = new QuantileSketch,
+            *global = new QuantileSketch;
+    MPI_Datatype sketch_type;
+    MPI_Op merge_op;
+
+    sketch_init(*local);
+#pragma omp parallel
+    {
+        QuantileSketch *mine = new QuantileSketch;
+        sketch_init(*mine);
+#pragma omp for schedule(static) nowait
+        for (int i = 0; i < local_num_data; i++)
+            sketch_add(*mine, local_data[i]);
+#pragma omp critical
+        sketch_merge(*local, *mine);
+        delete mine;
+    }
+
+    MPI_Type_contiguous(sizeof(QuantileSketch), MPI_BYTE, &sketch_type);
+    MPI_Type_commit(&sketch_type);
+    MPI_Op_create(sketchReduce, 1, &merge_op);
+    MPI_Reduce(local, global, 1, sketch_type, merge_op, 0, MPI_COMM_WORLD);
+    MPI_Op_free(&merge_op);
+    MPI_Type_free(&sketch_type);
+
+    if (rank_id == 0) {
+        sketch_compress(*global);
+        cout << "Quantiles of " << (long) global->total << " values from a sketch of "
+             << global->size << " centroids (" << sizeof(QuantileSketch) / 1024 << " KB):" << endl;
+        for (double q : queries)
+            printf("p%-8g %10.2f\n", q * 100, sketch_quantile(*global, min(max(q, 0.0), 1.0)));
+    }
+    delete local;
+    delete global;
+}
+
+/**
+ * Histogram of every rank's data counted into one shared array per node, summed across the
+ * nodes into bins of rank 0, for question 5. The ranks of a node write the same memory, so
+ * histogram_count_shared() adds with __atomic_fetch_add, atomic across processes on the
+ * shared pages, which an OpenMP atomic only promises between the threads of one process.
+ * @param local_data
+ * @param local_num_data
+ * @param bins      the result on rank 0, unused elsewhere
+ * @param num_bins
+ * @param rank_id
+ */
+void nodeHistogram(int local_data[], int local_num_data, int bins[], int num_bins, int rank_id) {
+    MPI_Comm node_comm,
+            leader_comm;
+    MPI_Win win;
+    MPI_Aint size;
+    int node_rank,
+            disp_unit,
+            range = histogram_range(MIN_RANGE, MAX_RANGE, num_bins),
+            *node_bins;
+
+    /** Rank 0 of every node allocates the node's bins; the others map them */
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank_id, MPI_INFO_NULL, &node_comm);
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Win_allocate_shared(node_rank == 0 ? (MPI_Aint) num_bins * sizeof(int) : 0, sizeof(int),
+                            MPI_INFO_NULL, node_comm, &node_bins, &win);
+    MPI_Win_shared_query(win, 0, &size, &disp_unit, &node_bins);
+
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, win);
+    if (node_rank == 0)
+        fill(node_bins, node_bins + num_bins, 0);
+    MPI_Win_sync(win);
+    MPI_Barrier(node_comm);
+
+    histogram_count_shared(local_data, local_num_data, MIN_RANGE, range, node_bins);
+    MPI_Win_sync(win);
+    MPI_Barrier(node_comm);
+    MPI_Win_sync(win);
+
+    /** The node leaders reduce across the nodes; world rank 0 leads its node */
+    MPI_Comm_split(MPI_COMM_WORLD, node_rank == 0 ? 0 : MPI_UNDEFINED, rank_id, &leader_comm);
+    if (leader_comm != MPI_COMM_NULL) {
+        MPI_Reduce(node_bins, bins, num_bins, MPI_INT, MPI_SUM, 0, leader_comm);
+        MPI_Comm_free(&leader_comm);
+    }
+    MPI_Win_unlock_all(win);
+
+    MPI_Win_free(&win);
+    MPI_Comm_free(&node_comm);
+}
@@ -0,0 +1,51 @@
+/**********************************
+ * DESCRIPTION: The binning loops of histogram.cpp, shared with the histogram kernels of
+ * benchmark.cpp.
+ *
+ * Values in [min_range, max_range] fall in num_bins bins of equal width, the last one
+ * narrower when the width does not divide the range. histogram_count() is the loop every
+ * rank runs on its own bins; histogram_count_shared() is the loop of question 5, where the
+ * threads and ranks of a node count into one array: its adds are __atomic_fetch_add, which
+ * stays atomic across processes mapping the same memory, and contend when bins are few.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   int range = histogram_range(MIN_RANGE, MAX_RANGE, num_bins);
+ *   histogram_count(data, n, MIN_RANGE, range, bins);          // bins zeroed by the caller
+ *   histogram_count_shared(data, n, MIN_RANGE, range, bins);   // bins shared by the counters
+**********************************/
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+/**
+ * Width of a bin, rounded up so the bins cover the range
+ */
+inline int histogram_range(int min_range, int max_range, int num_bins) {
+    return (max_range - min_range + num_bins) / num_bins;
+}
+
+/**
+ * Count n values into bins
+ * @param data
+ * @param n
+ * @param min_range
+ * @param range      width of a bin, histogram_range()
+ * @param bins
+ */
+inline void histogram_count(const int data[], long n, int min_range, int range, int bins[]) {
+    for (long i = 0; i < n; i++)
+        bins[(data[i] - min_range) / range]++;
+}
+
+/**
+ * Count n values into bins written concurrently by other threads or processes, in parallel
+ */
+inline void histogram_count_shared(const int data[], long n, int min_range, int range, int bins[]) {
+#pragma omp parallel for schedule(static)
+    for (long i = 0; i < n; i++)
+        __atomic_fetch_add(&bins[(data[i] - min_range) / range], 1, __ATOMIC_RELAXED);
+}
+
+#endif
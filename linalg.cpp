@@ -0,0 +1,743 @@
+/**********************************
+ * DESCRIPTION: Implementation of linalg.h.
+ *
+ * The LU factorization is right-looking and blocked: a panel of LU_BLOCK columns is factored
+ * with partial pivoting, the block row to its right is solved against the panel's unit lower
+ * triangle, and the trailing matrix gets one rank-LU_BLOCK update, the O(n^3) part, with the
+ * rows spread across the threads. Solves with many right-hand sides work on blocks of
+ * SOLVE_BLOCK columns at a time, so the inner loops run along rows.
+ *
+ * The Cholesky factorization follows the same blocked scheme on the packed lower triangle:
+ * the diagonal block is factored, the panel below it is solved row by row, and the trailing
+ * lower triangle is updated with axpys along the rows of the transposed panel.
+ *
+ * An inverse update forms Inv U and V^T Inv with the recursive multiply, solves the small
+ * capacitance system by LU, and applies the two rank-k updates with the rows spread across
+ * the threads. It is accepted only if no capacitance pivot is tiny next to the entries of
+ * V^T Inv U, which would mean the 1 of the identity cancelled, and |A x - z| <= UPDATE_TOLERANCE |A| |x| for x = Inv z and a few random z.
+ * A backward error that small does not rule out a singular A, whose computed inverse is
+ * merely huge, so the inverse computed again is also rejected when |A| |Inv| >= 1 / UPDATE_PIVOT.
+ *
+ * The recursive multiply works on views of row-major blocks, a pointer and a leading
+ * dimension, and accumulates C += A B so that halves of the inner dimension can share C.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USEFUL REFERENCE:
+ *    -> Partial pivoting: https://en.wikipedia.org/wiki/LU_decomposition#LU_factorization_with_partial_pivoting
+ *    -> Blocked LU: https://www.netlib.org/lapack/lug/node125.html
+ *    -> Cholesky: https://en.wikipedia.org/wiki/Cholesky_decomposition
+ *    -> Cache-oblivious algorithms: https://dl.acm.org/doi/10.1145/2071379.2071383
+ *    -> Strassen: https://en.wikipedia.org/wiki/Strassen_algorithm
+ *    -> Woodbury: https://en.wikipedia.org/wiki/Woodbury_matrix_identity
+**********************************/
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "linalg.h"
+
+using namespace std;
+
+const int LU_BLOCK = 64;
+const int SOLVE_BLOCK = 64;
+const int COLUMN_BLOCK = 256;
+const int RECURSE_LEAF = 64;
+const double TASK_WORK = 1 << 21;
+const double UPDATE_PIVOT = 1e-12;
+const double UPDATE_TOLERANCE = 1e-10;
+const int UPDATE_SAMPLES = 2;
+
+int lu_factor(const Matrix &A, LUFactors &F) {
+    if (A.rows != A.cols)
+        return LINALG_DIMENSION;
+
+    int n = A.rows;
+    Matrix &M = F.lu;
+    M = A;
+    F.perm.resize(n);
+    iota(F.perm.begin(), F.perm.end(), 0);
+    F.sign = 1;
+
+    for (int k0 = 0; k0 < n; k0 += LU_BLOCK) {
+        int k1 = min(k0 + LU_BLOCK, n);
+
+        /** Panel: columns k0..k1, unblocked, swapping whole rows */
+        for (int k = k0; k < k1; k++) {
+            int p = k;
+            double best = fabs(M(k, k));
+            for (int i = k + 1; i < n; i++) {
+                if (fabs(M(i, k)) > best) {
+                    best = fabs(M(i, k));
+                    p = i;
+                }
+            }
+            if (best == 0)
+                return LINALG_SINGULAR;
+            if (p != k) {
+                swap_ranges(M.row(k), M.row(k) + n, M.row(p));
+                swap(F.perm[k], F.perm[p]);
+                F.sign = -F.sign;
+            }
+
+            const double *mk = M.row(k);
+            double pivot = mk[k];
+#pragma omp parallel for schedule(static) if (n - k > 256)
+            for (int i = k + 1; i < n; i++) {
+                double *mi = M.row(i);
+                double l = mi[k] /= pivot;
+                for (int j = k + 1; j < k1; j++)
+                    mi[j] -= l * mk[j];
+            }
+        }
+        if (k1 == n)
+            break;
+
+        /** U12 = L11^-1 A12, independent per column */
+#pragma omp parallel for schedule(static)
+        for (int j0 = k1; j0 < n; j0 += COLUMN_BLOCK) {
+            int j1 = min(j0 + COLUMN_BLOCK, n);
+            for (int i = k0 + 1; i < k1; i++) {
+                double *mi = M.row(i);
+                for (int p = k0; p < i; p++) {
+                    double l = mi[p];
+                    const double *mp = M.row(p);
+                    for (int j = j0; j < j1; j++)
+                        mi[j] -= l * mp[j];
+                }
+            }
+        }
+
+        /** A22 -= L21 U12 */
+#pragma omp parallel for schedule(static)
+        for (int i = k1; i < n; i++) {
+            double *mi = M.row(i);
+            for (int j0 = k1; j0 < n; j0 += COLUMN_BLOCK) {
+                int j1 = min(j0 + COLUMN_BLOCK, n);
+                for (int p = k0; p < k1; p++) {
+                    double l = mi[p];
+                    const double *mp = M.row(p);
+                    for (int j = j0; j < j1; j++)
+                        mi[j] -= l * mp[j];
+                }
+            }
+        }
+    }
+    return LINALG_OK;
+}
+
+void lu_solve(const LUFactors &F, double b[]) {
+    const Matrix &M = F.lu;
+    int n = M.rows;
+    vector<double> x(n);
+
+    for (int i = 0; i < n; i++)
+        x[i] = b[F.perm[i]];
+
+    /** Forward substitution, L y = P b */
+    for (int i = 1; i < n; i++) {
+        const double *mi = M.row(i);
+        double sum = 0;
+        for (int j = 0; j < i; j++)
+            sum += mi[j] * x[j];
+        x[i] -= sum;
+    }
+
+    /** Back substitution, U x = y */
+    for (int i = n - 1; i >= 0; i--) {
+        const double *mi = M.row(i);
+        double sum = 0;
+        for (int j = i + 1; j < n; j++)
+            sum += mi[j] * x[j];
+        x[i] = (x[i] - sum) / mi[i];
+    }
+    copy(x.begin(), x.end(), b);
+}
+
+int lu_solve(const LUFactors &F, Matrix &B) {
+    const Matrix &M = F.lu;
+    int n = M.rows, m = B.cols;
+    if (B.rows != n)
+        return LINALG_DIMENSION;
+
+    Matrix X(n, m);
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; i++)
+        copy(B.row(F.perm[i]), B.row(F.perm[i]) + m, X.row(i));
+
+#pragma omp parallel for schedule(dynamic)
+    for (int c0 = 0; c0 < m; c0 += SOLVE_BLOCK) {
+        int c1 = min(c0 + SOLVE_BLOCK, m);
+
+        /** Forward substitution */
+        for (int i = 1; i < n; i++) {
+            const double *mi = M.row(i);
+            double *xi = X.row(i);
+            for (int p = 0; p < i; p++) {
+                double l = mi[p];
+                const double *xp = X.row(p);
+                for (int c = c0; c < c1; c++)
+                    xi[c] -= l * xp[c];
+            }
+        }
+
+        /** Back substitution */
+        for (int i = n - 1; i >= 0; i--) {
+            const double *mi = M.row(i);
+            double *xi = X.row(i);
+            for (int p = i + 1; p < n; p++) {
+                double u = mi[p];
+                const double *xp = X.row(p);
+                for (int c = c0; c < c1; c++)
+                    xi[c] -= u * xp[c];
+            }
+            double d = 1.0 / mi[i];
+            for (int c = c0; c < c1; c++)
+                xi[c] *= d;
+        }
+    }
+    B.data.swap(X.data);
+    return LINALG_OK;
+}
+
+int inverse(const LUFactors &F, Matrix &Inv) {
+    Inv = Matrix::identity(F.lu.rows);
+    return lu_solve(F, Inv);
+}
+
+double determinant(const LUFactors &F) {
+    double det = F.sign;
+    for (int i = 0; i < F.lu.rows; i++)
+        det *= F.lu(i, i);
+    return det;
+}
+
+int chol_factor(const Matrix &A, CholeskyFactors &F) {
+    if (A.rows != A.cols)
+        return LINALG_DIMENSION;
+
+    int n = A.rows;
+    vector<double> diagonal, panel;
+    F.n = n;
+    F.l.resize((size_t) n * (n + 1) / 2);
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; i++)
+        copy(A.row(i), A.row(i) + i + 1, F.row(i));
+
+    for (int k0 = 0; k0 < n; k0 += LU_BLOCK) {
+        int k1 = min(k0 + LU_BLOCK, n);
+
+        /** Diagonal block, unblocked */
+        for (int k = k0; k < k1; k++) {
+            double *lk = F.row(k);
+            if (!(lk[k] > 0))
+                return LINALG_NOT_SPD;
+            lk[k] = sqrt(lk[k]);
+            for (int i = k + 1; i < k1; i++) {
+                double *li = F.row(i);
+                li[k] /= lk[k];
+                for (int j = k + 1; j <= i; j++)
+                    li[j] -= li[k] * F(j, k);
+            }
+        }
+        if (k1 == n)
+            break;
+
+        /** L21 = A21 L11^-T, independent per row, with L11 transposed for row access */
+        int kb = k1 - k0;
+        diagonal.assign((size_t) kb * kb, 0);
+        for (int q = k0; q < k1; q++)
+            for (int k = k0; k <= q; k++)
+                diagonal[(size_t) (k - k0) * kb + q - k0] = F(q, k);
+
+#pragma omp parallel for schedule(static)
+        for (int i = k1; i < n; i++) {
+            double *li = F.row(i) + k0;
+            for (int k = 0; k < kb; k++) {
+                const double *dk = &diagonal[(size_t) k * kb];
+                double l = li[k] /= dk[k];
+                for (int q = k + 1; q < kb; q++)
+                    li[q] -= l * dk[q];
+            }
+        }
+
+        /** A22 -= L21 L21^T, lower triangle only, along rows of the transposed panel */
+        int m = n - k1;
+        panel.resize((size_t) (k1 - k0) * m);
+#pragma omp parallel for schedule(static)
+        for (int i = k1; i < n; i++)
+            for (int p = k0; p < k1; p++)
+                panel[(size_t) (p - k0) * m + i - k1] = F(i, p);
+
+#pragma omp parallel for schedule(dynamic, 16)
+        for (int i = k1; i < n; i++) {
+            double *li = F.row(i) + k1;
+            for (int p = k0; p < k1; p++) {
+                double l = panel[(size_t) (p - k0) * m + i - k1];
+                const double *pp = &panel[(size_t) (p - k0) * m];
+                for (int j = 0; j <= i - k1; j++)
+                    li[j] -= l * pp[j];
+            }
+        }
+    }
+    return LINALG_OK;
+}
+
+void chol_solve(const CholeskyFactors &F, double b[]) {
+    int n = F.n;
+
+    /** Forward substitution, L y = b */
+    for (int i = 0; i < n; i++) {
+        const double *li = F.row(i);
+        double sum = 0;
+        for (int j = 0; j < i; j++)
+            sum += li[j] * b[j];
+        b[i] = (b[i] - sum) / li[i];
+    }
+
+    /** Back substitution, L^T x = y, along the rows of L */
+    for (int i = n - 1; i >= 0; i--) {
+        const double *li = F.row(i);
+        b[i] /= li[i];
+        for (int j = 0; j < i; j++)
+            b[j] -= li[j] * b[i];
+    }
+}
+
+int chol_solve(const CholeskyFactors &F, Matrix &B) {
+    int n = F.n, m = B.cols;
+    if (B.rows != n)
+        return LINALG_DIMENSION;
+
+#pragma omp parallel for schedule(dynamic)
+    for (int c0 = 0; c0 < m; c0 += SOLVE_BLOCK) {
+        int c1 = min(c0 + SOLVE_BLOCK, m);
+
+        /** Forward substitution */
+        for (int i = 0; i < n; i++) {
+            const double *li = F.row(i);
+            double *xi = B.row(i);
+            for (int p = 0; p < i; p++) {
+                double l = li[p];
+                const double *xp = B.row(p);
+                for (int c = c0; c < c1; c++)
+                    xi[c] -= l * xp[c];
+            }
+            double d = 1.0 / li[i];
+            for (int c = c0; c < c1; c++)
+                xi[c] *= d;
+        }
+
+        /** Back substitution */
+        for (int i = n - 1; i >= 0; i--) {
+            const double *li = F.row(i);
+            double *xi = B.row(i);
+            double d = 1.0 / li[i];
+            for (int c = c0; c < c1; c++)
+                xi[c] *= d;
+            for (int p = 0; p < i; p++) {
+                double l = li[p];
+                double *xp = B.row(p);
+                for (int c = c0; c < c1; c++)
+                    xp[c] -= l * xi[c];
+            }
+        }
+    }
+    return LINALG_OK;
+}
+
+int chol_inverse(const CholeskyFactors &F, Matrix &Inv) {
+    int n = F.n;
+    CholeskyFactors W;
+
+    /** W = L^-1, lower triangular, by blocks of columns: W(i, :) = -(sum_p L(i, p) W(p, :)) / L(i, i) */
+    W.n = n;
+    W.l.assign(F.l.size(), 0);
+#pragma omp parallel for schedule(dynamic)
+    for (int j0 = 0; j0 < n; j0 += SOLVE_BLOCK) {
+        int j1 = min(j0 + SOLVE_BLOCK, n);
+        for (int i = j0; i < n; i++) {
+            const double *li = F.row(i);
+            double *wi = W.row(i);
+            int end = min(j1, i);
+            for (int p = j0; p < i; p++) {
+                double l = li[p];
+                const double *wp = W.row(p);
+                for (int j = j0; j < min(end, p + 1); j++)
+                    wi[j] -= l * wp[j];
+            }
+            for (int j = j0; j < end; j++)
+                wi[j] /= li[i];
+            if (i < j1)
+                wi[i] = 1.0 / li[i];
+        }
+    }
+
+    /** Lower triangle of W^T W: Inv(i, j) = sum_{p >= i} W(p, i) W(p, j), mirrored */
+    Inv = Matrix(n, n);
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int i = 0; i < n; i++) {
+        double *inv_i = Inv.row(i);
+        for (int p = i; p < n; p++) {
+            const double *wp = W.row(p);
+            double w = wp[i];
+            for (int j = 0; j <= i; j++)
+                inv_i[j] += w * wp[j];
+        }
+    }
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int i = 0; i < n; i++)
+        for (int j = i + 1; j < n; j++)
+            Inv(i, j) = Inv(j, i);
+    return LINALG_OK;
+}
+
+double determinant(const CholeskyFactors &F) {
+    double det = 1;
+    for (int i = 0; i < F.n; i++)
+        det *= F(i, i) * F(i, i);
+    return det;
+}
+
+bool is_symmetric(const Matrix &A, double tolerance) {
+    if (A.rows != A.cols)
+        return false;
+
+    double largest = 0;
+    for (double a : A.data)
+        largest = max(largest, fabs(a));
+    for (int i = 0; i < A.rows; i++)
+        for (int j = 0; j < i; j++)
+            if (fabs(A(i, j) - A(j, i)) > tolerance * largest)
+                return false;
+    return true;
+}
+
+int inverse_auto(const Matrix &A, Matrix &Inv, InverseMethod *method) {
+    bool positive_diagonal = A.rows == A.cols;
+    for (int i = 0; positive_diagonal && i < A.rows; i++)
+        positive_diagonal = A(i, i) > 0;
+
+    if (positive_diagonal && is_symmetric(A)) {
+        CholeskyFactors G;
+        if (chol_factor(A, G) == LINALG_OK) {
+            if (method)
+                *method = INVERSE_CHOLESKY;
+            return chol_inverse(G, Inv);
+        }
+    }
+
+    LUFactors F;
+    int rc = lu_factor(A, F);
+    if (method)
+        *method = INVERSE_LU;
+    return rc != LINALG_OK ? rc : inverse(F, Inv);
+}
+
+/**
+ * C += scale X Y for an n x k matrix X and a k x m matrix Y, one row of C per iteration
+ */
+static void add_product(Matrix &C, const Matrix &X, const Matrix &Y, double scale) {
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < C.rows; i++) {
+        double *ci = C.row(i);
+        for (int c = 0; c < X.cols; c++) {
+            double r = scale * X(i, c);
+            if (r == 0)
+                continue;
+            const double *yc = Y.row(c);
+            for (int j = 0; j < C.cols; j++)
+                ci[j] += r * yc[j];
+        }
+    }
+}
+
+/**
+ * Whether Inv passes the backward error test of the inverse of A on random vectors
+ */
+static bool inverse_accurate(const Matrix &A, const Matrix &Inv) {
+    int n = A.rows;
+    double norm = 0;
+#pragma omp parallel for reduction(max:norm)
+    for (int i = 0; i < n; i++) {
+        double sum = 0;
+        for (int j = 0; j < n; j++)
+            sum += fabs(A(i, j));
+        norm = max(norm, sum);
+    }
+
+    vector<double> z(n), x(n);
+    for (int s = 0; s < UPDATE_SAMPLES; s++) {
+        for (int i = 0; i < n; i++)
+            z[i] = ((((unsigned) i + 1) * 2654435761u + (unsigned) s * 40503u) >> 16 & 1) ? 1.0 : -1.0;
+        double x_norm = 0, residual = 0;
+#pragma omp parallel for reduction(max:x_norm)
+        for (int i = 0; i < n; i++) {
+            const double *row = Inv.row(i);
+            double sum = 0;
+            for (int j = 0; j < n; j++)
+                sum += row[j] * z[j];
+            x[i] = sum;
+            x_norm = max(x_norm, fabs(sum));
+        }
+#pragma omp parallel for reduction(max:residual)
+        for (int i = 0; i < n; i++) {
+            const double *row = A.row(i);
+            double sum = -z[i];
+            for (int j = 0; j < n; j++)
+                sum += row[j] * x[j];
+            residual = max(residual, fabs(sum));
+        }
+        if (!(residual <= UPDATE_TOLERANCE * norm * x_norm))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Whether |A| |Inv| in the infinity norm, an estimate of the condition number, is below 1 / UPDATE_PIVOT
+ */
+static bool inverse_conditioned(const Matrix &A, const Matrix &Inv) {
+    int n = A.rows;
+    double a_norm = 0, inv_norm = 0;
+#pragma omp parallel for reduction(max:a_norm, inv_norm)
+    for (int i = 0; i < n; i++) {
+        double a_sum = 0, inv_sum = 0;
+        for (int j = 0; j < n; j++) {
+            a_sum += fabs(A(i, j));
+            inv_sum += fabs(Inv(i, j));
+        }
+        a_norm = max(a_norm, a_sum);
+        inv_norm = max(inv_norm, inv_sum);
+    }
+    return a_norm * inv_norm * UPDATE_PIVOT < 1;
+}
+
+int inverse_update(Matrix &A, Matrix &Inv, const Matrix &U, const Matrix &V, bool *refactored) {
+    int n = A.rows, k = U.cols;
+    if (A.cols != n || Inv.rows != n || Inv.cols != n || U.rows != n || V.rows != n || V.cols != k)
+        return LINALG_DIMENSION;
+    if (refactored)
+        *refactored = false;
+
+    /** A += U V^T */
+    Matrix Vt(k, n), IU, VtI, C;
+    for (int i = 0; i < n; i++)
+        for (int c = 0; c < k; c++)
+            Vt(c, i) = V(i, c);
+    add_product(A, U, Vt, 1);
+
+    /** C = I + V^T Inv U, and Z = C^-1 V^T Inv in place of V^T Inv */
+    multiply_recursive(Inv, U, IU);
+    multiply_recursive(Vt, Inv, VtI);
+    multiply(Vt, IU, C);
+    double largest = 1, smallest = INFINITY;
+    for (double c : C.data)
+        largest = max(largest, fabs(c));
+    for (int c = 0; c < k; c++)
+        C(c, c) += 1;
+
+    /** A pivot lost to cancellation against the terms of C means A + U V^T is nearly singular */
+    LUFactors F;
+    bool stable = lu_factor(C, F) == LINALG_OK;
+    for (int c = 0; c < k; c++)
+        smallest = min(smallest, fabs(F.lu(c, c)));
+    stable = stable && smallest > UPDATE_PIVOT * largest;
+
+    if (stable) {
+        lu_solve(F, VtI);
+        add_product(Inv, IU, VtI, -1);
+        stable = inverse_accurate(A, Inv);
+    }
+    if (stable)
+        return LINALG_OK;
+
+    if (refactored)
+        *refactored = true;
+    int status = inverse_auto(A, Inv);
+    if (status == LINALG_OK && !(inverse_conditioned(A, Inv) && inverse_accurate(A, Inv)))
+        status = LINALG_SINGULAR;
+    return status;
+}
+
+int inverse_update_rows(Matrix &A, Matrix &Inv, const vector<int> &rows, const Matrix &R, bool *refactored) {
+    int n = A.rows, k = (int) rows.size();
+    if (refactored)
+        *refactored = false;
+    if (R.rows != k || R.cols != A.cols)
+        return LINALG_DIMENSION;
+    if (k == 0)
+        return LINALG_OK;
+    vector<int> sorted(rows);
+    sort(sorted.begin(), sorted.end());
+    if (k > 0 && (sorted.front() < 0 || sorted.back() >= n || adjacent_find(sorted.begin(), sorted.end()) != sorted.end()))
+        return LINALG_DIMENSION;
+
+    Matrix U(n, k), V(A.cols, k);
+    for (int c = 0; c < k; c++) {
+        U(rows[c], c) = 1;
+        for (int j = 0; j < A.cols; j++)
+            V(j, c) = R(c, j) - A(rows[c], j);
+    }
+    return inverse_update(A, Inv, U, V, refactored);
+}
+
+int multiply(const Matrix &A, const Matrix &B, Matrix &C) {
+    if (A.cols != B.rows)
+        return LINALG_DIMENSION;
+
+    int n = A.rows, m = B.cols, inner = A.cols;
+    C = Matrix(n, m);
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; i++) {
+        double *ci = C.row(i);
+        const double *ai = A.row(i);
+        for (int k = 0; k < inner; k++) {
+            double r = ai[k];
+            const double *bk = B.row(k);
+            for (int j = 0; j < m; j++)
+                ci[j] += r * bk[j];
+        }
+    }
+    return LINALG_OK;
+}
+
+/**
+ * C += A B for an m x k block A and a k x n block B, at most RECURSE_LEAF on each side
+ */
+static void multiply_leaf(const double *a, int lda, const double *b, int ldb, double *c, int ldc,
+                          int m, int k, int n) {
+    for (int i = 0; i < m; i++) {
+        double *ci = c + (size_t) i * ldc;
+        for (int p = 0; p < k; p++) {
+            double r = a[(size_t) i * lda + p];
+            const double *bp = b + (size_t) p * ldb;
+            for (int j = 0; j < n; j++)
+                ci[j] += r * bp[j];
+        }
+    }
+}
+
+/**
+ * C = X + sign Y for h x h blocks, into a contiguous buffer
+ */
+static void add_blocks(const double *x, int ldx, const double *y, int ldy, double sign, double *c, int h) {
+    for (int i = 0; i < h; i++)
+        for (int j = 0; j < h; j++)
+            c[(size_t) i * h + j] = x[(size_t) i * ldx + j] + sign * y[(size_t) i * ldy + j];
+}
+
+static void multiply_block(const double *a, int lda, const double *b, int ldb, double *c, int ldc,
+                           int m, int k, int n, int strassen_cutoff);
+
+/**
+ * One Strassen step, C += A B for n x n blocks with n even
+ */
+static void multiply_strassen(const double *a, int lda, const double *b, int ldb, double *c, int ldc,
+                              int n, int strassen_cutoff) {
+    int h = n / 2;
+    size_t hh = (size_t) h * h;
+    const double *a11 = a, *a12 = a + h, *a21 = a + (size_t) h * lda, *a22 = a21 + h;
+    const double *b11 = b, *b12 = b + h, *b21 = b + (size_t) h * ldb, *b22 = b21 + h;
+    double *c11 = c, *c12 = c + h, *c21 = c + (size_t) h * ldc, *c22 = c21 + h;
+    vector<double> buffer(hh * 17, 0);
+    double *s = buffer.data(), *t = s + 5 * hh, *mm = t + 5 * hh;
+    double *M[7];
+    for (int i = 0; i < 7; i++)
+        M[i] = mm + i * hh;
+
+    add_blocks(a11, lda, a22, lda, 1, s, h);
+    add_blocks(b11, ldb, b22, ldb, 1, t, h);
+    add_blocks(a21, lda, a22, lda, 1, s + hh, h);
+    add_blocks(b12, ldb, b22, ldb, -1, t + hh, h);
+    add_blocks(b21, ldb, b11, ldb, -1, t + 2 * hh, h);
+    add_blocks(a11, lda, a12, lda, 1, s + 2 * hh, h);
+    add_blocks(a21, lda, a11, lda, -1, s + 3 * hh, h);
+    add_blocks(b11, ldb, b12, ldb, 1, t + 3 * hh, h);
+    add_blocks(a12, lda, a22, lda, -1, s + 4 * hh, h);
+    add_blocks(b21, ldb, b22, ldb, 1, t + 4 * hh, h);
+
+    /** M1 = (A11 + A22)(B11 + B22), M2 = (A21 + A22) B11, M3 = A11 (B12 - B22), M4 = A22 (B21 - B11),
+     *  M5 = (A11 + A12) B22, M6 = (A21 - A11)(B11 + B12), M7 = (A12 - A22)(B21 + B22) */
+    const double *left[7] = {s, s + hh, a11, a22, s + 2 * hh, s + 3 * hh, s + 4 * hh};
+    const int left_ld[7] = {h, h, lda, lda, h, h, h};
+    const double *right[7] = {t, b11, t + hh, t + 2 * hh, b22, t + 3 * hh, t + 4 * hh};
+    const int right_ld[7] = {h, ldb, h, h, ldb, h, h};
+    bool tasks = (double) h * h * h > TASK_WORK;
+    for (int i = 0; i < 7; i++) {
+#pragma omp task if (tasks)
+        multiply_block(left[i], left_ld[i], right[i], right_ld[i], M[i], h, h, h, h, strassen_cutoff);
+    }
+#pragma omp taskwait
+
+    for (int i = 0; i < h; i++) {
+        double *r11 = c11 + (size_t) i * ldc, *r12 = c12 + (size_t) i * ldc;
+        double *r21 = c21 + (size_t) i * ldc, *r22 = c22 + (size_t) i * ldc;
+        const double *m1 = M[0] + (size_t) i * h, *m2 = M[1] + (size_t) i * h, *m3 = M[2] + (size_t) i * h;
+        const double *m4 = M[3] + (size_t) i * h, *m5 = M[4] + (size_t) i * h, *m6 = M[5] + (size_t) i * h;
+        const double *m7 = M[6] + (size_t) i * h;
+        for (int j = 0; j < h; j++) {
+            r11[j] += m1[j] + m4[j] - m5[j] + m7[j];
+            r12[j] += m3[j] + m5[j];
+            r21[j] += m2[j] + m4[j];
+            r22[j] += m1[j] - m2[j] + m3[j] + m6[j];
+        }
+    }
+}
+
+/**
+ * C += A B for an m x k block A and a k x n block B, halving the largest dimension
+ */
+static void multiply_block(const double *a, int lda, const double *b, int ldb, double *c, int ldc,
+                           int m, int k, int n, int strassen_cutoff) {
+    bool tasks = (double) m * k * n > TASK_WORK;
+
+    if (m <= RECURSE_LEAF && k <= RECURSE_LEAF && n <= RECURSE_LEAF) {
+        multiply_leaf(a, lda, b, ldb, c, ldc, m, k, n);
+    } else if (strassen_cutoff > 0 && m == k && k == n && n % 2 == 0 && n > strassen_cutoff) {
+        multiply_strassen(a, lda, b, ldb, c, ldc, n, strassen_cutoff);
+    } else if (m >= k && m >= n) {
+        int h = m / 2;
+#pragma omp task if (tasks)
+        multiply_block(a, lda, b, ldb, c, ldc, h, k, n, strassen_cutoff);
+        multiply_block(a + (size_t) h * lda, lda, b, ldb, c + (size_t) h * ldc, ldc, m - h, k, n, strassen_cutoff);
+#pragma omp taskwait
+    } else if (n >= k) {
+        int h = n / 2;
+#pragma omp task if (tasks)
+        multiply_block(a, lda, b, ldb, c, ldc, m, k, h, strassen_cutoff);
+        multiply_block(a, lda, b + h, ldb, c + h, ldc, m, k, n - h, strassen_cutoff);
+#pragma omp taskwait
+    } else {
+        /** Both halves of the inner dimension accumulate into the same C, one after the other */
+        int h = k / 2;
+        multiply_block(a, lda, b, ldb, c, ldc, m, h, n, strassen_cutoff);
+        multiply_block(a + h, lda, b + (size_t) h * ldb, ldb, c, ldc, m, k - h, n, strassen_cutoff);
+    }
+}
+
+int multiply_recursive(const Matrix &A, const Matrix &B, Matrix &C, int strassen_cutoff) {
+    if (A.cols != B.rows)
+        return LINALG_DIMENSION;
+
+    C = Matrix(A.rows, B.cols);
+    if (A.rows == 0 || A.cols == 0 || B.cols == 0)
+        return LINALG_OK;
+#pragma omp parallel
+#pragma omp single
+    multiply_block(A.data.data(), A.cols, B.data.data(), B.cols, C.data.data(), C.cols,
+                   A.rows, A.cols, B.cols, strassen_cutoff);
+    return LINALG_OK;
+}
+
+double inverse_error(const Matrix &A, const Matrix &B) {
+    Matrix C;
+    double error = 0;
+
+    if (multiply_recursive(A, B, C) != LINALG_OK || C.rows != C.cols)
+        return INFINITY;
+    for (int i = 0; i < C.rows; i++)
+        for (int j = 0; j < C.cols; j++)
+            error = max(error, fabs(C(i, j) - (i == j ? 1.0 : 0.0)));
+    return error;
+}
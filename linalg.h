@@ -0,0 +1,282 @@
+/**********************************
+ * DESCRIPTION: Dense linear algebra extracted from matrix_inverse.cpp: LU decomposition with
+ * partial pivoting, factored once and reused for any number of solves, the inverse and the
+ * determinant, and the Cholesky decomposition for symmetric positive-definite matrices.
+ *
+ * Cholesky needs a third of the flops of LU and keeps only the lower triangle, packed by
+ * rows. inverse_auto() uses it for symmetric matrices and falls back to LU when the matrix
+ * turns out not to be positive definite.
+ *
+ * When a few rows or a low-rank term of A change, inverse_update() and inverse_update_rows()
+ * update an existing inverse in O(n^2 k) by the Sherman-Morrison-Woodbury formula instead of
+ * inverting again, and invert again only when the update fails a stability check.
+ *
+ * A matrix is factored in O(n^3) by lu_factor(); every later solve with the factors costs
+ * O(n^2) per right-hand side, so systems sharing a matrix should share one factorization
+ * rather than one inverse each. All routines return 0 on success or a LINALG_* error code,
+ * and run in parallel with OpenMP when it is enabled.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   LUFactors F;
+ *   if (lu_factor(A, F) == LINALG_OK) {
+ *       lu_solve(F, b);          // one right-hand side, in place
+ *       lu_solve(F, B);          // the columns of B, in place
+ *       inverse(F, Inv);
+ *       double det = determinant(F);
+ *   }
+ *
+ *   CholeskyFactors G;             // A symmetric positive definite
+ *   if (chol_factor(A, G) == LINALG_OK)
+ *       chol_inverse(G, Inv);
+ *
+ *   inverse_update_rows(A, Inv, rows, R);   // rows[c] of A becomes row c of R
+**********************************/
+#ifndef LINALG_H
+#define LINALG_H
+
+#include <vector>
+#include <cstddef>
+
+enum LinalgStatus {
+    LINALG_OK = 0,
+    LINALG_SINGULAR = 1,
+    LINALG_DIMENSION = 2,
+    LINALG_NOT_SPD = 3
+};
+
+enum InverseMethod {
+    INVERSE_LU,
+    INVERSE_CHOLESKY
+};
+
+/**
+ * Dense row-major matrix of doubles
+ */
+class Matrix {
+public:
+    int rows;
+    int cols;
+    std::vector<double> data;
+
+    Matrix() : rows(0), cols(0) {}
+
+    Matrix(int rows, int cols, double value = 0) : rows(rows), cols(cols), data((size_t) rows * cols, value) {}
+
+    static Matrix identity(int n) {
+        Matrix I(n, n);
+        for (int i = 0; i < n; i++)
+            I(i, i) = 1;
+        return I;
+    }
+
+    double &operator()(int i, int j) {
+        return data[(size_t) i * cols + j];
+    }
+
+    const double &operator()(int i, int j) const {
+        return data[(size_t) i * cols + j];
+    }
+
+    double *row(int i) {
+        return &data[(size_t) i * cols];
+    }
+
+    const double *row(int i) const {
+        return &data[(size_t) i * cols];
+    }
+};
+
+/**
+ * P A = L U, with L unit lower triangular and U upper triangular stored together in lu
+ */
+struct LUFactors {
+    Matrix lu;
+    std::vector<int> perm;  // row i of P A is row perm[i] of A
+    int sign = 1;           // determinant of P
+};
+
+/**
+ * A = L L^T, the lower triangle of L packed by rows: L(i, j), j <= i, is l[i (i + 1) / 2 + j]
+ */
+struct CholeskyFactors {
+    int n = 0;
+    std::vector<double> l;
+
+    double &operator()(int i, int j) {
+        return l[(size_t) i * (i + 1) / 2 + j];
+    }
+
+    const double &operator()(int i, int j) const {
+        return l[(size_t) i * (i + 1) / 2 + j];
+    }
+
+    double *row(int i) {
+        return &l[(size_t) i * (i + 1) / 2];
+    }
+
+    const double *row(int i) const {
+        return &l[(size_t) i * (i + 1) / 2];
+    }
+};
+
+/**
+ * Factor a square matrix, blocked and right-looking with partial pivoting
+ * @param A
+ * @param F
+ * @return LINALG_SINGULAR when a pivot is exactly zero
+ */
+int lu_factor(const Matrix &A, LUFactors &F);
+
+/**
+ * Solve A x = b for one right-hand side, overwriting b with x
+ * @param F
+ * @param b  n values
+ */
+void lu_solve(const LUFactors &F, double b[]);
+
+/**
+ * Solve A X = B for the columns of B, overwriting B with X
+ * @param F
+ * @param B  n rows, any number of columns
+ * @return LINALG_DIMENSION when B has the wrong number of rows
+ */
+int lu_solve(const LUFactors &F, Matrix &B);
+
+/**
+ * Inverse of the factored matrix, solving for the columns of the identity
+ * @param F
+ * @param Inv
+ * @return
+ */
+int inverse(const LUFactors &F, Matrix &Inv);
+
+/**
+ * Determinant from the diagonal of U and the sign of the permutation
+ * @param F
+ * @return
+ */
+double determinant(const LUFactors &F);
+
+/**
+ * Factor a symmetric positive-definite matrix, blocked and right-looking like lu_factor(),
+ * reading only the lower triangle of A
+ * @param A
+ * @param F
+ * @return LINALG_NOT_SPD when a pivot is not positive
+ */
+int chol_factor(const Matrix &A, CholeskyFactors &F);
+
+/**
+ * Solve A x = b for one right-hand side, overwriting b with x
+ * @param F
+ * @param b  n values
+ */
+void chol_solve(const CholeskyFactors &F, double b[]);
+
+/**
+ * Solve A X = B for the columns of B, overwriting B with X
+ * @param F
+ * @param B
+ * @return LINALG_DIMENSION when B has the wrong number of rows
+ */
+int chol_solve(const CholeskyFactors &F, Matrix &B);
+
+/**
+ * Inverse as L^-T L^-1, computing the lower triangle and mirroring it
+ * @param F
+ * @param Inv
+ * @return
+ */
+int chol_inverse(const CholeskyFactors &F, Matrix &Inv);
+
+/**
+ * Determinant as the squared product of the diagonal of L
+ * @param F
+ * @return
+ */
+double determinant(const CholeskyFactors &F);
+
+/**
+ * Whether A is square and symmetric up to a relative tolerance of its largest entry
+ * @param A
+ * @param tolerance
+ * @return
+ */
+bool is_symmetric(const Matrix &A, double tolerance = 1e-12);
+
+/**
+ * Inverse with Cholesky when A is symmetric with a positive diagonal, otherwise or when
+ * Cholesky fails with LU
+ * @param A
+ * @param Inv
+ * @param method  set to the method used, or NULL
+ * @return
+ */
+int inverse_auto(const Matrix &A, Matrix &Inv, InverseMethod *method = NULL);
+
+/**
+ * Replace A by A + U V^T and Inv, the inverse of A, by the inverse of the result, as
+ * Inv - Inv U (I + V^T Inv U)^-1 V^T Inv in O(n^2 k). When the k x k capacitance matrix
+ * I + V^T Inv U is close to singular, or the normwise backward error of the new inverse on
+ * random vectors exceeds UPDATE_TOLERANCE, e.g. after many updates piled up rounding
+ * errors, Inv is computed again from A by inverse_auto(). The result is LINALG_SINGULAR when
+ * that inverse fails the backward error test too or |A| |Inv| reaches 1 / UPDATE_PIVOT; A has then
+ * already been updated and Inv is undefined.
+ * @param A           n x n, updated in place
+ * @param Inv         n x n, updated in place
+ * @param U           n x k
+ * @param V           n x k
+ * @param refactored  set to whether Inv was computed again, or NULL
+ * @return LINALG_DIMENSION when the shapes do not match, LINALG_SINGULAR when the updated
+ *         matrix is singular or too close to it, with A updated and Inv undefined
+ */
+int inverse_update(Matrix &A, Matrix &Inv, const Matrix &U, const Matrix &V, bool *refactored = NULL);
+
+/**
+ * Replace row rows[c] of A by row c of R for every c and update Inv, as inverse_update()
+ * with U the columns rows[c] of the identity and V^T the change of the rows
+ * @param A
+ * @param Inv
+ * @param rows        distinct row indices
+ * @param R           rows.size() x n
+ * @param refactored  set to whether Inv was computed again, or NULL
+ * @return LINALG_DIMENSION for bad shapes or repeated rows, LINALG_SINGULAR as inverse_update(),
+ *         with the rows of A replaced and Inv undefined
+ */
+int inverse_update_rows(Matrix &A, Matrix &Inv, const std::vector<int> &rows, const Matrix &R,
+                        bool *refactored = NULL);
+
+/**
+ * C = A B
+ * @param A
+ * @param B
+ * @param C
+ * @return LINALG_DIMENSION when the shapes do not match
+ */
+int multiply(const Matrix &A, const Matrix &B, Matrix &C);
+
+/**
+ * C = A B by cache-oblivious recursion, halving the largest of the three dimensions until
+ * the blocks fit in cache, with OpenMP tasks for the independent halves. Square blocks
+ * larger than strassen_cutoff take a Strassen step, seven products instead of eight, at the
+ * price of some accuracy and temporary memory.
+ * @param A
+ * @param B
+ * @param C
+ * @param strassen_cutoff  0 for no Strassen steps
+ * @return LINALG_DIMENSION when the shapes do not match
+ */
+int multiply_recursive(const Matrix &A, const Matrix &B, Matrix &C, int strassen_cutoff = 0);
+
+/**
+ * Largest absolute entry of A B - I, the error of an inverse B of A
+ * @param A
+ * @param B
+ * @return
+ */
+double inverse_error(const Matrix &A, const Matrix &B);
+
+#endif
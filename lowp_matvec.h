@@ -0,0 +1,163 @@
+/**********************************
+ * DESCRIPTION: Integer mat-vec on narrow storage, for matrices of small integers such as the
+ * 0/1 matrices of matrix-multiplication-openmp.cpp.
+ *
+ * A mat-vec reads every element of the matrix once, so it runs at memory bandwidth and its
+ * time is the size of the matrix. LowpMatrix<T> stores the elements as T, and
+ * lowp_matvec() picks the kernel by T:
+ *   int       4 bytes per element, the plain loop
+ *   int16_t   2 bytes, _mm256_madd_epi16: 16 products summed in pairs into 32-bit lanes
+ *   int8_t    1 byte, _mm256_maddubs_epi16 on |a| and x with the sign of a, pairs of
+ *             products into 16 bits, then _mm256_madd_epi16 into 32-bit lanes
+ *   bool      1 bit, rows packed in 64-bit words, a dot product is popcount(a & x) per word
+ * Without AVX2 the int16_t and int8_t kernels are the plain loop, which the compiler still
+ * vectorizes with widening. Rows are padded with zeros to 64 bytes, so there are no tails.
+ * Sums are 32-bit: |A(i, j) x(j)| summed over a row must fit an int; int8_t elements must be
+ * in [-127, 127] so a pair of products fits 16 bits.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   LowpMatrix<int8_t> A(n, n), x(1, n);      // or int16_t, int, bool
+ *   A.set(i, j, v); x.set(0, j, v);
+ *   lowp_matvec(A, x, y);                     // int y[n]
+ *
+ * USEFUL REFERENCE:
+ *    -> Intrinsics: https://www.intel.com/content/www/us/en/docs/intrinsics-guide/index.html
+**********************************/
+#ifndef LOWP_MATVEC_H
+#define LOWP_MATVEC_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+const long LOWP_ROW_BYTES = 64;
+
+/**
+ * Row-major matrix of T with rows padded to LOWP_ROW_BYTES
+ */
+template<class T>
+struct LowpMatrix {
+    long rows;
+    long cols;
+    long stride;               // elements per padded row
+    std::vector<T> data;
+
+    LowpMatrix(long rows, long cols) : rows(rows), cols(cols),
+            stride((cols * (long) sizeof(T) + LOWP_ROW_BYTES - 1) / LOWP_ROW_BYTES * LOWP_ROW_BYTES / sizeof(T)),
+            data((size_t) rows * stride, 0) {}
+
+    void set(long i, long j, int v) {
+        data[i * stride + j] = (T) v;
+    }
+
+    const T *row(long i) const {
+        return &data[i * stride];
+    }
+
+    size_t bytes() const {
+        return data.size() * sizeof(T);
+    }
+};
+
+/**
+ * 0/1 matrix, bit j of a row in bit j % 64 of word j / 64
+ */
+template<>
+struct LowpMatrix<bool> {
+    long rows;
+    long cols;
+    long stride;               // words per padded row
+    std::vector<uint64_t> data;
+
+    LowpMatrix(long rows, long cols) : rows(rows), cols(cols),
+            stride((cols + LOWP_ROW_BYTES * 8 - 1) / (LOWP_ROW_BYTES * 8) * (LOWP_ROW_BYTES / 8)),
+            data((size_t) rows * stride, 0) {}
+
+    void set(long i, long j, int v) {
+        uint64_t bit = (uint64_t) 1 << (j % 64);
+        if (v)
+            data[i * stride + j / 64] |= bit;
+        else
+            data[i * stride + j / 64] &= ~bit;
+    }
+
+    const uint64_t *row(long i) const {
+        return &data[i * stride];
+    }
+
+    size_t bytes() const {
+        return data.size() * sizeof(uint64_t);
+    }
+};
+
+template<class T>
+inline int lowp_dot(const T *a, const T *x, long n) {
+    int sum = 0;
+    for (long j = 0; j < n; j++)
+        sum += (int) a[j] * (int) x[j];
+    return sum;
+}
+
+inline int lowp_dot(const uint64_t *a, const uint64_t *x, long words) {
+    int sum = 0;
+    for (long w = 0; w < words; w++)
+        sum += __builtin_popcountll(a[w] & x[w]);
+    return sum;
+}
+
+#if defined(__AVX2__)
+inline int lowp_hsum(__m256i v) {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+inline int lowp_dot(const int16_t *a, const int16_t *x, long n) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    for (long j = 0; j < n; j += 32) {
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *) (a + j)),
+                                                        _mm256_loadu_si256((const __m256i *) (x + j))));
+        acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *) (a + j + 16)),
+                                                        _mm256_loadu_si256((const __m256i *) (x + j + 16))));
+    }
+    return lowp_hsum(_mm256_add_epi32(acc0, acc1));
+}
+
+/**
+ * _mm256_maddubs_epi16 multiplies unsigned by signed bytes, so |a| times x with the sign of a
+ */
+inline int lowp_dot(const int8_t *a, const int8_t *x, long n) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    for (long j = 0; j < n; j += 64) {
+        __m256i a0 = _mm256_loadu_si256((const __m256i *) (a + j)),
+                x0 = _mm256_loadu_si256((const __m256i *) (x + j)),
+                a1 = _mm256_loadu_si256((const __m256i *) (a + j + 32)),
+                x1 = _mm256_loadu_si256((const __m256i *) (x + j + 32));
+        __m256i p0 = _mm256_maddubs_epi16(_mm256_abs_epi8(a0), _mm256_sign_epi8(x0, a0)),
+                p1 = _mm256_maddubs_epi16(_mm256_abs_epi8(a1), _mm256_sign_epi8(x1, a1));
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(p0, ones));
+        acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(p1, ones));
+    }
+    return lowp_hsum(_mm256_add_epi32(acc0, acc1));
+}
+#endif
+
+/**
+ * y = A x, x a matrix of one row
+ */
+template<class T>
+void lowp_matvec(const LowpMatrix<T> &A, const LowpMatrix<T> &x, int y[]) {
+#pragma omp parallel for schedule(static)
+    for (long i = 0; i < A.rows; i++)
+        y[i] = lowp_dot(A.row(i), x.row(0), A.stride);
+}
+
+#endif
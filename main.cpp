@@ -1,4 +1,10 @@
 #include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cmath>
 #include <omp.h>
 
 /**
@@ -33,11 +39,411 @@ void reduction_sum() {
     std::cout << sum << std::endl;
 }
 
+/**
+ * User-defined reductions over compound types
+ */
+const int HIST_BINS = 64;
+
+struct MinLoc {
+    double value;
+    long index;
+};
+
+struct KahanSum {
+    double sum = 0;
+    double c = 0;
+
+    void add(double x) {
+        double y = x - c;
+        double t = sum + y;
+        c = (t - sum) - y;
+        sum = t;
+    }
+
+    void merge(const KahanSum &other) {
+        add(other.sum);
+        add(-other.c);
+    }
+};
+
+struct Histogram {
+    long bins[HIST_BINS] = {};
+
+    Histogram &operator+=(const Histogram &other) {
+        for (int i = 0; i < HIST_BINS; i++) {
+            bins[i] += other.bins[i];
+        }
+        return *this;
+    }
+};
+
+struct Vec3 {
+    double x = 0, y = 0, z = 0;
+
+    Vec3 &operator+=(const Vec3 &other) {
+        x += other.x;
+        y += other.y;
+        z += other.z;
+        return *this;
+    }
+};
+
+// Ties keep the lowest index so the result does not depend on the thread count
+#pragma omp declare reduction(minloc : MinLoc : \
+        omp_out = (omp_in.value < omp_out.value || \
+                   (omp_in.value == omp_out.value && omp_in.index < omp_out.index)) ? omp_in : omp_out) \
+        initializer(omp_priv = MinLoc{INFINITY, -1})
+#pragma omp declare reduction(maxloc : MinLoc : \
+        omp_out = (omp_in.value > omp_out.value || \
+                   (omp_in.value == omp_out.value && omp_in.index < omp_out.index)) ? omp_in : omp_out) \
+        initializer(omp_priv = MinLoc{-INFINITY, -1})
+#pragma omp declare reduction(+ : KahanSum : omp_out.merge(omp_in))
+#pragma omp declare reduction(+ : Histogram : omp_out += omp_in)
+#pragma omp declare reduction(+ : Vec3 : omp_out += omp_in)
+
+/**
+ * Custom Reductions
+ */
+void custom_reductions() {
+    double array[10] = {3.5, -1.0, 7.25, 0.5, -1.0, 9.0, 2.0, 9.0, -0.5, 4.0};
+    MinLoc lo{INFINITY, -1}, hi{-INFINITY, -1};
+    KahanSum sum;
+    Histogram hist;
+    Vec3 centroid;
+
+#pragma omp parallel for reduction(minloc:lo) reduction(maxloc:hi) reduction(+:sum, hist, centroid)
+    for (int i = 0; i < 10; i++) {
+        if (array[i] < lo.value) lo = MinLoc{array[i], i};
+        if (array[i] > hi.value) hi = MinLoc{array[i], i};
+        sum.add(array[i]);
+        hist.bins[(int) (array[i] + 1.0)]++;
+        centroid += Vec3{(double) i, array[i], 1.0};
+    }
+
+    std::cout << "min " << lo.value << " at " << lo.index << ", max " << hi.value << " at " << hi.index
+              << ", sum " << sum.sum << ", centroid (" << centroid.x / 10 << ", " << centroid.y / 10 << ")"
+              << ", bin[0] " << hist.bins[0] << std::endl;
+}
+
+/**
+ * Cheap deterministic value in [0, 1) for element i, so 10^9 elements need no memory
+ */
+inline double element(long i) {
+    return (double) (((unsigned long) i * 2654435761UL) & 0xFFFFFF) * (1.0 / 16777216.0);
+}
+
+struct alignas(64) PaddedSum {
+    double value = 0;
+};
+
+struct alignas(64) PaddedHistogram {
+    Histogram hist;
+};
+
+void report_reduction(const char *group, const char *method, long n, double seconds, double result) {
+    std::cout << std::left << std::setw(11) << group << std::setw(26) << method << std::right
+              << std::setw(12) << n << std::fixed << std::setprecision(3) << std::setw(11) << seconds * 1e3
+              << std::setw(10) << seconds * 1e9 / n << std::setprecision(6) << std::setw(20) << result
+              << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+}
+
+/**
+ * Reduction Benchmark
+ * Compare built-in and user-defined reductions against manual per-thread accumulators
+ * (padded to a cache line and unpadded, i.e. with false sharing) and atomics. Atomics are
+ * run on at most 10^8 elements, compare them per element.
+ */
+void reduction_benchmark(long n) {
+    const long atomic_n = std::min(n, 100000000L);
+    const int threads = omp_get_max_threads();
+    double start;
+
+    std::cout << "\n**************** Reduction Benchmark ****************\n";
+    std::cout << "Threads: " << threads << std::endl;
+    std::cout << std::left << std::setw(11) << "group" << std::setw(26) << "method" << std::right
+              << std::setw(12) << "elements" << std::setw(11) << "time(ms)" << std::setw(10) << "ns/elem"
+              << std::setw(20) << "result" << std::endl;
+
+    /** Sum */
+    {
+        double sum = 0;
+        start = omp_get_wtime();
+#pragma omp parallel for reduction(+:sum)
+        for (long i = 0; i < n; i++) {
+            sum += element(i);
+        }
+        report_reduction("sum", "reduction(+)", n, omp_get_wtime() - start, sum);
+    }
+    {
+        KahanSum sum;
+        start = omp_get_wtime();
+#pragma omp parallel for reduction(+:sum)
+        for (long i = 0; i < n; i++) {
+            sum.add(element(i));
+        }
+        report_reduction("sum", "declare reduction(kahan)", n, omp_get_wtime() - start, sum.sum - sum.c);
+    }
+    {
+        std::vector<PaddedSum> partial(threads);
+        start = omp_get_wtime();
+#pragma omp parallel
+        {
+            double local = 0;
+#pragma omp for
+            for (long i = 0; i < n; i++) {
+                local += element(i);
+            }
+            partial[omp_get_thread_num()].value = local;
+        }
+        double sum = 0;
+        for (const PaddedSum &p : partial) {
+            sum += p.value;
+        }
+        report_reduction("sum", "padded per-thread", n, omp_get_wtime() - start, sum);
+    }
+    {
+        std::vector<double> partial(threads, 0.0);
+        start = omp_get_wtime();
+#pragma omp parallel
+        {
+            double *local = &partial[omp_get_thread_num()];
+#pragma omp for
+            for (long i = 0; i < n; i++) {
+                *local += element(i);
+            }
+        }
+        double sum = 0;
+        for (double p : partial) {
+            sum += p;
+        }
+        report_reduction("sum", "unpadded per-thread", n, omp_get_wtime() - start, sum);
+    }
+    {
+        double sum = 0;
+        start = omp_get_wtime();
+#pragma omp parallel for
+        for (long i = 0; i < atomic_n; i++) {
+#pragma omp atomic
+            sum += element(i);
+        }
+        report_reduction("sum", "atomic", atomic_n, omp_get_wtime() - start, sum);
+    }
+
+    /** Min with index */
+    {
+        MinLoc lo{INFINITY, -1};
+        start = omp_get_wtime();
+#pragma omp parallel for reduction(minloc:lo)
+        for (long i = 0; i < n; i++) {
+            double x = element(i);
+            if (x < lo.value) lo = MinLoc{x, i};
+        }
+        report_reduction("minloc", "declare reduction", n, omp_get_wtime() - start, (double) lo.index);
+    }
+    {
+        double lo = INFINITY;
+        start = omp_get_wtime();
+#pragma omp parallel for reduction(min:lo)
+        for (long i = 0; i < n; i++) {
+            lo = std::min(lo, element(i));
+        }
+        report_reduction("minloc", "reduction(min), no index", n, omp_get_wtime() - start, lo);
+    }
+
+    /** Histogram */
+    {
+        long bins[HIST_BINS] = {};
+        start = omp_get_wtime();
+#pragma omp parallel for reduction(+:bins[:HIST_BINS])
+        for (long i = 0; i < n; i++) {
+            bins[(int) (element(i) * HIST_BINS)]++;
+        }
+        report_reduction("histogram", "array section", n, omp_get_wtime() - start, (double) bins[0]);
+    }
+    {
+        Histogram hist;
+        start = omp_get_wtime();
+#pragma omp parallel for reduction(+:hist)
+        for (long i = 0; i < n; i++) {
+            hist.bins[(int) (element(i) * HIST_BINS)]++;
+        }
+        report_reduction("histogram", "declare reduction", n, omp_get_wtime() - start, (double) hist.bins[0]);
+    }
+    {
+        std::vector<PaddedHistogram> partial(threads);
+        Histogram hist;
+        start = omp_get_wtime();
+#pragma omp parallel
+        {
+            Histogram &local = partial[omp_get_thread_num()].hist;
+#pragma omp for
+            for (long i = 0; i < n; i++) {
+                local.bins[(int) (element(i) * HIST_BINS)]++;
+            }
+        }
+        for (const PaddedHistogram &p : partial) {
+            hist += p.hist;
+        }
+        report_reduction("histogram", "padded per-thread", n, omp_get_wtime() - start, (double) hist.bins[0]);
+    }
+    {
+        long bins[HIST_BINS] = {};
+        start = omp_get_wtime();
+#pragma omp parallel for
+        for (long i = 0; i < atomic_n; i++) {
+#pragma omp atomic
+            bins[(int) (element(i) * HIST_BINS)]++;
+        }
+        report_reduction("histogram", "atomic", atomic_n, omp_get_wtime() - start, (double) bins[0]);
+    }
+
+    /** Small vector */
+    {
+        Vec3 v;
+        start = omp_get_wtime();
+#pragma omp parallel for reduction(+:v)
+        for (long i = 0; i < n; i++) {
+            double x = element(i);
+            v += Vec3{x, x * x, 1.0};
+        }
+        report_reduction("vec3", "declare reduction", n, omp_get_wtime() - start, v.y);
+    }
+    {
+        double x_sum = 0, y_sum = 0, z_sum = 0;
+        start = omp_get_wtime();
+#pragma omp parallel for reduction(+:x_sum, y_sum, z_sum)
+        for (long i = 0; i < n; i++) {
+            double x = element(i);
+            x_sum += x;
+            y_sum += x * x;
+            z_sum += 1.0;
+        }
+        report_reduction("vec3", "reduction(+) x3", n, omp_get_wtime() - start, y_sum);
+    }
+}
+
+/**
+ * Synthetic iteration cost, `units` dependent multiply-adds
+ */
+double spin(int units) {
+    double x = 1.0;
+    for (int i = 0; i < units; i++) {
+        x = x * 0.999999 + 1e-7;
+    }
+    return x;
+}
+
+/**
+ * Iteration costs of the synthetic workloads, all with a mean of about `mean` units
+ */
+std::vector<int> make_workload(const std::string &name, int iterations, int mean) {
+    std::vector<int> cost(iterations);
+    std::mt19937 engine(42);
+
+    if (name == "uniform") {
+        std::fill(cost.begin(), cost.end(), mean);
+    } else if (name == "increasing") {
+        for (int i = 0; i < iterations; i++) {
+            cost[i] = 2 * mean * (i + 1) / iterations;
+        }
+    } else {
+        // Pareto with alpha 1.5 and x_m = mean / 3, capped at 100x the mean
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        for (int i = 0; i < iterations; i++) {
+            double x = mean / 3.0 / std::pow(1.0 - u(engine), 1.0 / 1.5);
+            cost[i] = (int) std::min(x, 100.0 * mean);
+        }
+    }
+    return cost;
+}
+
 /**
  * Load Balance Schedule
+ * Run each synthetic workload under each loop schedule and thread count, and report the
+ * best wall time of a few runs, the busy time of each thread in that run and the imbalance
+ * (slowest thread / mean thread - 1).
  */
 void schedule() {
+    const int iterations = 4096;
+    const int mean = 2000;
+    const int repeats = 3;
+
+    struct Schedule {
+        const char *name;
+        omp_sched_t kind;
+        int chunk;
+    };
+    const Schedule schedules[] = {
+            {"static",    omp_sched_static,  0},
+            {"static,16", omp_sched_static,  16},
+            {"dynamic",   omp_sched_dynamic, 1},
+            {"dynamic,8", omp_sched_dynamic, 8},
+            {"guided",    omp_sched_guided,  1},
+            {"auto",      omp_sched_auto,    0},
+    };
+    const char *workloads[] = {"uniform", "increasing", "heavy-tail"};
 
+    std::vector<int> thread_counts;
+    for (int t = 1; t < omp_get_max_threads(); t *= 2) {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(omp_get_max_threads());
+
+    std::cout << "\n**************** Load Balance Schedule ****************\n";
+    std::cout << std::left << std::setw(12) << "workload" << std::setw(11) << "schedule"
+              << std::right << std::setw(8) << "threads" << std::setw(12) << "wall(ms)"
+              << std::setw(12) << "busy max" << std::setw(12) << "busy min"
+              << std::setw(11) << "imbalance" << std::endl;
+
+    double sink = 0;
+    for (const char *workload : workloads) {
+        std::vector<int> cost = make_workload(workload, iterations, mean);
+
+        for (const Schedule &s : schedules) {
+            omp_set_schedule(s.kind, s.chunk);
+
+            for (int threads : thread_counts) {
+                double best = 1e30;
+                std::vector<double> busy, best_busy;
+
+                for (int r = 0; r < repeats; r++) {
+                    busy.assign(threads, 0.0);
+                    double start = omp_get_wtime();
+#pragma omp parallel num_threads(threads) reduction(+:sink)
+                    {
+                        double begin = omp_get_wtime();
+#pragma omp for schedule(runtime) nowait
+                        for (int i = 0; i < iterations; i++) {
+                            sink += spin(cost[i]);
+                        }
+                        busy[omp_get_thread_num()] = omp_get_wtime() - begin;
+                    }
+                    double wall = omp_get_wtime() - start;
+                    if (wall < best) {
+                        best = wall;
+                        best_busy = busy;
+                    }
+                }
+
+                double max_busy = *std::max_element(best_busy.begin(), best_busy.end());
+                double min_busy = *std::min_element(best_busy.begin(), best_busy.end());
+                double sum_busy = 0;
+                for (double b : best_busy) {
+                    sum_busy += b;
+                }
+                double imbalance = max_busy / (sum_busy / threads) - 1.0;
+
+                std::cout << std::left << std::setw(12) << workload << std::setw(11) << s.name
+                          << std::right << std::setw(8) << threads << std::fixed << std::setprecision(3)
+                          << std::setw(12) << best * 1e3 << std::setw(12) << max_busy * 1e3
+                          << std::setw(12) << min_busy * 1e3 << std::setw(10) << imbalance * 100 << "%"
+                          << std::endl;
+            }
+        }
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6) << "(checksum " << sink << ")" << std::endl;
 }
 
 /**
@@ -63,7 +469,8 @@ void library_routines() {
     };
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    long n = argc > 1 ? (long) std::stod(argv[1]) : 1000000000L;
 
     /** Hello World*/
     hello_world();
@@ -71,6 +478,15 @@ int main() {
     /** Reduction Sum*/
     reduction_sum();
 
+    /** Custom Reductions*/
+    custom_reductions();
+
+    /** Reduction Benchmark*/
+    reduction_benchmark(n);
+
+    /** Load Balance Schedule*/
+    schedule();
+
     /** Run-time Library Routines*/
     library_routines();
 
@@ -0,0 +1,142 @@
+/**********************************
+ * DESCRIPTION: Square matrix multiplication, the classic loop of omp_saxp.c against the
+ * row-wise multiply() and the recursive multiply_recursive() of linalg.h, with and without
+ * Strassen steps, for speed and numerical error.
+ *
+ * The error of a method is the largest |C(i, j) - exact| / sum_k |A(i, k) B(k, j)| over a
+ * sample of entries, the exact value accumulated in long double. Strassen trades a few
+ * digits for fewer flops; the rate is reported in classic-equivalent GFLOP/s, 2 n^3 / time.
+ * Every method is timed by bench.h, the median over -r repeats, one by default.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   COMPILE: g++ -O3 -march=native -fopenmp matmul_recursive.cpp linalg.cpp -o matmul_recursive
+ *   RUN: ./matmul_recursive [-n size] [-s strassen_cutoff] [-r repeats] [-c]
+ *   -c skips the classic loop, which is very slow for n >= 4096.
+ *
+ * USEFUL REFERENCE:
+ *    -> Cache-oblivious algorithms: https://dl.acm.org/doi/10.1145/2071379.2071383
+ *    -> Strassen: https://en.wikipedia.org/wiki/Strassen_algorithm
+**********************************/
+#include <iostream>
+#include <functional>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <cmath>
+#include <omp.h>
+#include "bench.h"
+#include "linalg.h"
+
+using namespace std;
+
+const int samples = 256;
+
+/**
+ * The classic loop of omp_saxp.c, a dot product per entry
+ */
+void multiply_classic(const Matrix &A, const Matrix &B, Matrix &C) {
+    int n = A.rows;
+    C = Matrix(n, n);
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < n; k++) {
+            double sum = 0.0;
+            for (int j = 0; j < n; j++)
+                sum = sum + A(i, j) * B(j, k);
+            C(i, k) = sum;
+        }
+    }
+}
+
+/**
+ * Largest relative error over a sample of entries
+ */
+double sample_error(const Matrix &A, const Matrix &B, const Matrix &C) {
+    mt19937 engine(42);
+    uniform_int_distribution<> u(0, A.rows - 1);
+    double error = 0;
+
+    for (int s = 0; s < samples; s++) {
+        int i = u(engine), j = u(engine);
+        long double exact = 0, scale = 0;
+        for (int k = 0; k < A.cols; k++) {
+            exact += (long double) A(i, k) * B(k, j);
+            scale += fabsl((long double) A(i, k) * B(k, j));
+        }
+        if (scale > 0)
+            error = max(error, (double) (fabsl(C(i, j) - exact) / scale));
+    }
+    return error;
+}
+
+/**
+ * Time one method and print its rate and error
+ */
+void run(const string &name, const Matrix &A, const Matrix &B, const BenchOptions &options,
+         const function<void(Matrix &)> &method) {
+    Matrix C;
+    double n = A.rows;
+
+    BenchResult r = bench_measure(name, omp_get_max_threads(), A.rows, 2.0 * n * n * n * 1e-9, "GFLOP/s",
+                                  [&]() { method(C); }, options);
+    printf("%-26s %10.3f %10.3f %12.2e\n", name.c_str(), r.median, r.rate(), sample_error(A, B, C));
+}
+
+/**
+ * Main function
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char *argv[]) {
+    int n = 2048, cutoff = 256, opt;
+    bool classic = true;
+    BenchOptions options;
+    options.warmup = 0;
+    options.repeats = 1;
+
+    while ((opt = getopt(argc, argv, "n:s:r:c")) != -1) {
+        switch (opt) {
+            case 'n':
+                n = atoi(optarg);
+                break;
+            case 's':
+                cutoff = atoi(optarg);
+                break;
+            case 'r':
+                options.repeats = max(1, atoi(optarg));
+                break;
+            case 'c':
+                classic = false;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n size] [-s strassen_cutoff] [-r repeats] [-c]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (n < 1 || cutoff < 1) {
+        fprintf(stderr, "Size and cutoff must be positive\n");
+        return 1;
+    }
+
+    Matrix A(n, n), B(n, n);
+    mt19937 engine(1);
+    uniform_real_distribution<> u(-1.0, 1.0);
+    for (double &a : A.data)
+        a = u(engine);
+    for (double &b : B.data)
+        b = u(engine);
+
+    printf("Size: %d, threads: %d, Strassen cutoff: %d\n", n, omp_get_max_threads(), cutoff);
+    printf("%-26s %10s %10s %12s\n", "method", "median(s)", "GFLOP/s", "rel_error");
+    if (classic)
+        run("classic", A, B, options, [&](Matrix &C) { multiply_classic(A, B, C); });
+    run("multiply", A, B, options, [&](Matrix &C) { multiply(A, B, C); });
+    run("recursive", A, B, options, [&](Matrix &C) { multiply_recursive(A, B, C); });
+    run("recursive + strassen", A, B, options, [&](Matrix &C) { multiply_recursive(A, B, C, cutoff); });
+    return 0;
+}
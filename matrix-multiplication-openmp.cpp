@@ -1,11 +1,18 @@
 /**********************************
  * DESCRIPTION: A program to do the parallel matrix multiplication by using OpenMP
  *
+ * The 0/1 matrix-vector product is also run on the narrow storage of lowp_matvec.h, int16,
+ * int8 and packed bits, which moves 2, 4 and 32 times fewer bytes than int; every result
+ * is checked against the int product.
+ *
  * Author: Kejie Zhang
- * LAST UPDATED: 02/13/2019
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE: g++ matrix-multiplication-openmp.cpp -O3 -march=native -fopenmp -std=c++11 -o matrix-multiplication-openmp
+ *   RUN: ./matrix-multiplication-openmp [size]
+ *   Sizes well beyond the caches, e.g. 20000, show the bandwidth saving.
+ *   Add -DUSE_PERF_COUNTERS to report the perf_event counters of every mat-vec (perf_counters.h).
  *
- * USAGE: g++ matrix-multiplication-openmp.cpp -fopenmp -std=c++11 -o matrix-multiplication-openmp
- * 
  * USEFUL REFERENCE:
  *    -> OpenMP: https://computing.llnl.gov/tutorials/openMP/
 **********************************/
@@ -15,12 +22,17 @@
 #include <string>
 #include <omp.h>
 #include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include "lowp_matvec.h"
+#ifdef USE_PERF_COUNTERS
+#include "perf_counters.h"
+#endif
 
 using namespace std;
 
 #define MATRIX_SIZE 1000
-
-vector<int> result(MATRIX_SIZE, 0);
+#define REPEATS 10
 
 /**
  * Populate the Vector and Matrix with integer numbers selected randomly and uniformly in the range [0, m].
@@ -99,18 +111,64 @@ void printMatrix(vector<vector<int>> A) {
     }
 }
 
-int main() {
+/**
+ * Time the mat-vec on storage T, best of REPEATS, and check it against the int result
+ * @return 0 when the result matches
+ */
+template<class T>
+int runMatvec(const char *name, const vector<vector<int>> &X, const vector<int> &Y, const vector<int> &expected) {
+    long n = (long) Y.size();
+    LowpMatrix<T> A(n, n), x(1, n);
+    vector<int> y(n);
+    double best = 1e30;
+
+#pragma omp parallel for schedule(static)
+    for (long i = 0; i < n; i++)
+        for (long j = 0; j < n; j++)
+            A.set(i, j, X[i][j]);
+    for (long j = 0; j < n; j++)
+        x.set(0, j, Y[j]);
+
+#ifdef USE_PERF_COUNTERS
+    static perf_region_t region;
+    perf_region_init(&region, name);
+    perf_region_begin(&region);
+#endif
+    for (int r = 0; r < REPEATS; r++) {
+        double start = omp_get_wtime();
+        lowp_matvec(A, x, y.data());
+        best = min(best, omp_get_wtime() - start);
+    }
+#ifdef USE_PERF_COUNTERS
+    perf_region_end(&region);
+#endif
+    int rc = y == expected ? 0 : 1;
+    printf("%-8s %12.2f %12.3f %10.2f   %s\n", name, A.bytes() / 1048576.0, best * 1e3,
+           A.bytes() / best * 1e-9, rc == 0 ? "[CORRECT]" : "[WRONG]");
+#ifdef USE_PERF_COUNTERS
+    perf_region_report(&region, 0);
+#endif
+    return rc;
+}
+
+int main(int argc, char *argv[]) {
+    int size = argc > 1 ? atoi(argv[1]) : MATRIX_SIZE;
+    if (size < 1) {
+        cerr << "The size must be positive" << endl;
+        return 1;
+    }
+    vector<int> result(size, 0);
 
     cout << "\n********** CPU Information **********" << endl;
     cout << "Number of CPU cores: " << omp_get_num_procs() << endl;
 
     cout << "\n********** Matrix-Vector Multiplication **********" << endl;
     vector<vector<int>> X;
-    vector<int> Y(MATRIX_SIZE, 0);
+    vector<int> Y(size, 0);
 
     cout << "Initializing Matrix X...";
-    for (int i = 0; i < MATRIX_SIZE; i++) {
-        vector<int> row(MATRIX_SIZE, 0);
+    for (int i = 0; i < size; i++) {
+        vector<int> row(size, 0);
         populateVectorRandom(row, 1, 1);
         X.push_back(row);
     }
@@ -121,24 +179,37 @@ int main() {
     cout << "DONE" << endl;
 
     cout << "Running the Multiplication between X and Y..." << endl;
-    int i, j;
-    int sum = 0;
-#pragma omp parallel shared(X, Y, result) private(i, j)
-    {
-        cout << "Thread " << omp_get_thread_num() << " is running" << endl;
-        for (i = 0; i < MATRIX_SIZE; i++) {
-#pragma omp parallel for reduction (+:sum)
-            for (j = 0; j < MATRIX_SIZE; j++)
-                sum += X[i][j] * Y[j];
-            result[i] = sum;
-            sum = 0;
-        }
+#ifdef USE_PERF_COUNTERS
+    static perf_region_t region;
+    perf_region_init(&region, "matvec");
+    perf_region_begin(&region);
+#endif
+    /** One row per iteration, each with its own sum */
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < size; i++) {
+        int sum = 0;
+        for (int j = 0; j < size; j++)
+            sum += X[i][j] * Y[j];
+        result[i] = sum;
     }
+#ifdef USE_PERF_COUNTERS
+    perf_region_end(&region);
+#endif
     cout << "\nDONE" << endl;
+#ifdef USE_PERF_COUNTERS
+    perf_region_report(&region, 0);
+#endif
 
     cout << "\n********** Resulting Vector **********\n";
     printVector(result);
+
+    cout << "\n********** Narrow Storage **********\n";
+    printf("%-8s %12s %12s %10s\n", "storage", "matrix(MB)", "time(ms)", "GB/s");
+    int rc = runMatvec<int>("int", X, Y, result)
+             | runMatvec<int16_t>("int16", X, Y, result)
+             | runMatvec<int8_t>("int8", X, Y, result)
+             | runMatvec<bool>("bits", X, Y, result);
     cout << "********** Exit **********\n";
 
-    return 0;
+    return rc;
 }
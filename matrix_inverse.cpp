@@ -1,17 +1,30 @@
 /**********************************
  * DESCRIPTION: A program to do matrix inversion with the help of LU Decomposition
- * by Doolittle algorithm using pthreads.
+ * with partial pivoting (linalg.h) and pthreads.
+ *
+ * The matrix is factored once, then the threads split the columns of the identity and solve
+ * for their columns of the inverse with the shared factors.
+ *
+ * Symmetric matrices take the Cholesky path instead, a third of the flops of LU on one
+ * triangle, and fall back to LU when they turn out not to be positive definite.
+ *
+ * Then a few rows of the matrix are replaced, and the inverse is updated for them in
+ * O(n^2 k) by inverse_update_rows() (Sherman-Morrison-Woodbury) rather than computed again.
  *
  * Author: Kejie Zhang
- * LAST UPDATED: 03/05/2019
+ * LAST UPDATED: 10/18/2026
  *
  * USAGE:
- *   COMPILE: g++ matrix_inverse.cpp -pthread -std=c++11 -O3 -o matrix_inverse
- *   RUN: ./matrix_inverse
+ *   COMPILE: g++ matrix_inverse.cpp linalg.cpp -pthread -fopenmp -std=c++17 -O3 -o matrix_inverse
+ *   RUN: ./matrix_inverse [spd | matrix.csv]
+ *   spd generates a symmetric positive-definite matrix M M^T instead of a sparse one; a file
+ *   name reads a square matrix, one row per line, with csv_reader.h.
+ *   Add -DUSE_PERF_COUNTERS to report the perf_event counters of both phases (perf_counters.h).
  *
  * USEFUL REFERENCE:
  *    -> Doolittle: https://www.geeksforgeeks.org/doolittle-algorithm-lu-decomposition/
  *    -> Forward and Back Substitution: https://www.gaussianwaves.com/2013/05/solving-a-triangular-matrix-using-forward-backward-substitution/
+ *    -> Cholesky: https://en.wikipedia.org/wiki/Cholesky_decomposition
 **********************************/
 #include <iostream>
 #include <random>
@@ -22,50 +35,40 @@
 #include <utility>
 #include <vector>
 #include <pthread.h>
+#include "linalg.h"
+#include "csv_reader.h"
+#ifdef USE_PERF_COUNTERS
+#include "perf_counters.h"
+#endif
 
 using namespace std;
 
 const int matrix_size = 1000;
 const int num_threads = 8;
-
-vector <vector<int>>
-        A(matrix_size, vector<int>(matrix_size));
-vector <vector<double>>
-        U(matrix_size, vector<double>(matrix_size, 0)),
-        L(matrix_size, vector<double>(matrix_size, 0)),
-        C(matrix_size, vector<double>(matrix_size)),
-        Inv(matrix_size, vector<double>(matrix_size, 0)),
-        Identity(matrix_size, vector<double>(matrix_size));
-vector<int>
-        Prow(matrix_size),
-        Pcol(matrix_size);
+const double tolerance = 1e-6;
+const int update_rows = 8;
 
 struct thread_data {
+    int id;
     int lo;
     int hi;
+    const LUFactors *F;
+    Matrix *Inv;
 };
 
+#ifdef USE_PERF_COUNTERS
+perf_region_t lu_region, substitution_region;
+#endif
+
 class Printer {
 public:
-    void print_matrix(vector <vector<int>> M, string const &message) {
-        cout << endl;
-        cout << message << endl;
-        int i, j;
-        for (i = 0; i < matrix_size; i++) {
-            for (j = 0; j < matrix_size; j++)
-                cout << setprecision(2) << M[i][j] << "\t";
-            cout << endl;
-        }
-        cout << endl;
-    }
-
-    void print_matrix(vector <vector<double>> M, string const &message) {
+    void print_matrix(const Matrix &M, string const &message) {
         cout << endl;
         cout << message << endl;
         int i, j;
-        for (i = 0; i < matrix_size; i++) {
-            for (j = 0; j < matrix_size; j++)
-                cout << setprecision(2) << M[i][j] << "\t";
+        for (i = 0; i < M.rows; i++) {
+            for (j = 0; j < M.cols; j++)
+                cout << setprecision(2) << M(i, j) << "\t";
             cout << endl;
         }
         cout << endl;
@@ -79,97 +82,26 @@ private:
 
 public:
     void start() {
-        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &begin);
+        clock_gettime(CLOCK_MONOTONIC, &begin);
     }
 
     void stop() {
-        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+        clock_gettime(CLOCK_MONOTONIC, &end);
     }
 
     double getInterval() {
-        if (&begin != NULL && &end != NULL)
-            return ((end.tv_sec - begin.tv_sec) * 1e3 + (end.tv_nsec - begin.tv_nsec) * 1e-6) * 1e-3;
-        else
-            return -1;
+        return ((end.tv_sec - begin.tv_sec) * 1e3 + (end.tv_nsec - begin.tv_nsec) * 1e-6) * 1e-3;
     }
 };
 
 /**
- * LU Decomposition with Doolittle Algorithm
- */
-
-void LUDecomposition(vector <vector<int>> &A, vector <vector<double>> &L, vector <vector<double>> &U) {
-    for (int i = 0; i < matrix_size; i++) {
-
-        // Upper Triangular
-        for (int k = i; k < matrix_size; k++) {
-            double sum = 0;
-            for (int j = 0; j < i; j++)
-                sum += (L[i][j] * U[j][k]);
-            U[i][k] = A[i][k] - sum;
-        }
-
-        // Lower Triangular
-        for (int k = i; k < matrix_size; k++) {
-            if (i == k)
-                L[i][i] = 1;
-            else {
-                double sum = 0;
-                for (int j = 0; j < i; j++)
-                    sum += (L[k][j] * U[j][i]);
-                L[k][i] = (A[k][i] - sum) / U[i][i];
-            }
-        }
-    }
-}
-
-/**
- * Forward Substitution
- * @param col
- * @param L
- * @param U
- */
-void triangle_forward_sub(int col, vector <vector<double>> &L, vector <vector<double>> &U) {
-    int _col = col;
-    int i, j;
-    if (Pcol[_col] != 0)
-        C[_col][0] = 0;
-    else C[_col][0] = 1 / L[0][0];
-    for (j = 1; j < matrix_size; j++) {
-        double sum = 0;
-        for (i = 0; i < j; i++)
-            sum += L[j][i] * C[_col][i];
-        if (Pcol[_col] != j)
-            C[_col][j] = -sum;
-        else C[_col][j] = 1 - sum;
-    }
-}
-
-/**
- * Backward substitution
- * @param col
- * @param U
- */
-void triangle_back_sub(int col, vector <vector<double>> &U) {
-    int _col = col;
-    int i, j;
-    Inv[matrix_size - 1][_col] = C[_col][matrix_size - 1] / U[matrix_size - 1][matrix_size - 1];
-    for (i = matrix_size - 2; i > -1; i--) {
-        double sum = 0;
-        for (j = i + 1; j < matrix_size; j++)
-            sum += U[i][j] * Inv[j][_col];
-        Inv[i][_col] = (C[_col][i] - sum) / U[i][i];
-    }
-}
-
-/**
- * Helper function to populate vector randomly or uniformly in a range.
+ * Helper function to populate a matrix randomly or uniformly in a range.
  * @param A
  * @param start
  * @param end
  * @param flag
  */
-void populateVectorRandom(vector <vector<int>> &A, double start, double end, int flag) {
+void populateVectorRandom(Matrix &A, double start, double end, int flag) {
     int i,
             j;
     /** Generate random sequence*/
@@ -180,143 +112,276 @@ void populateVectorRandom(vector <vector<int>> &A, double start, double end, int
 
     /** Populate random numbers into vectors uniformly */
     if (flag == 1) {
-        for (i = 0; i < A.size(); i++) {
-            for (j = 0; j < A[0].size(); j++) {
-                A[i][j] = u(engine);
+        for (i = 0; i < A.rows; i++) {
+            for (j = 0; j < A.cols; j++) {
+                A(i, j) = u(engine);
             }
         }
     }
 
     /** Generate Sparse Matrix */
     if (flag == 2) {
-        for (i = 0; i < A.size(); i++) {
-            for (j = 0; j < A[0].size(); j++) {
+        for (i = 0; i < A.rows; i++) {
+            for (j = 0; j < A.cols; j++) {
                 if(b(engine) == 1) {
-                    A[i][j] = u(engine);
+                    A(i, j) = u(engine);
                 } else {
-                    A[i][j] = 0;
+                    A(i, j) = 0;
                 }
             }
         }
     }
 }
 
+/**
+ * Symmetric positive-definite matrix M M^T + I, with M random in a range
+ * @param A
+ * @param start
+ * @param end
+ */
+void populateSPD(Matrix &A, double start, double end) {
+    Matrix M(A.rows, A.cols), Mt(A.cols, A.rows);
+    int i, j;
+
+    populateVectorRandom(M, start, end, 1);
+    for (i = 0; i < M.rows; i++)
+        for (j = 0; j < M.cols; j++)
+            Mt(j, i) = M(i, j);
+    multiply(M, Mt, A);
+    for (i = 0; i < A.rows; i++)
+        A(i, i) += 1;
+}
+
+/**
+ * Read a square matrix from a file, one row per line
+ * @param path
+ * @param A
+ * @return LINALG_DIMENSION when the file cannot be read or the matrix is not square
+ */
+int readMatrix(const char *path, Matrix &A) {
+    vector<double> values;
+    long rows, cols;
+
+    int rc = csv_read(path, values, &rows, &cols);
+    if (rc != CSV_OK || rows != cols || rows == 0) {
+        cout << "[FAILED]" << endl;
+        fprintf(stderr, "Cannot read a square matrix from %s (error %d, %ld x %ld)\n", path, rc, rows, cols);
+        return LINALG_DIMENSION;
+    }
+    A = Matrix((int) rows, (int) cols);
+    A.data.swap(values);
+    return LINALG_OK;
+}
+
+/**
+ * Forward and backward substitution for the columns lo..hi of the inverse
+ * @param param
+ * @return
+ */
 void *triangle_inverse(void *param) {
-    int lo = ((thread_data *) param)->lo;
-    int hi = ((thread_data *) param)->hi;
-    int i;
-    for (i = lo; i < hi; i++) {
-        triangle_forward_sub(i, L, U);
-        triangle_back_sub(i, U);
+    thread_data *data = (thread_data *) param;
+    int n = data->Inv->rows, i, j;
+    vector<double> column(n);
+#ifdef USE_PERF_COUNTERS
+    perf_thread_start(&substitution_region, data->id);
+#endif
+    for (i = data->lo; i < data->hi; i++) {
+        fill(column.begin(), column.end(), 0);
+        column[i] = 1;
+        lu_solve(*data->F, column.data());
+        for (j = 0; j < n; j++)
+            (*data->Inv)(j, i) = column[j];
     }
+#ifdef USE_PERF_COUNTERS
+    perf_thread_stop(&substitution_region, data->id);
+#endif
     pthread_exit(NULL);
     return 0;
 }
 
 /**
- * Check the correctness of matrix inversion.
- * Use kij format for a cache-friendly matrix multiplication
+ * Inverse by Cholesky Decomposition
  * @param A
  * @param Inv
- * @param Identity
- * @return bool
+ * @param clock
+ * @return LINALG_NOT_SPD when A is not positive definite
  */
-int check(vector <vector<int>> &A, vector <vector<double>> &Inv, vector <vector<double>> &Identity) {
-    int i, j, k, r, size;
-    size = A.size();
-    for (k = 0; k < size; k++) {
-        for (i = 0; i < size; i++) {
-            r = A[i][k];
-            for (j = 0; j < size; j++) {
-                Identity[i][j] += r * Inv[k][j];
-            }
-        }
-    }
+int cholesky_inverse(const Matrix &A, Matrix &Inv, Clock &clock) {
+    CholeskyFactors G;
+    int rc;
+    double time;
 
-    for (i = 0; i < size; i++) {
-        for (j = 0; j < size; j++) {
-            Identity[i][j] = lround(Identity[i][j]);
-        }
+    cout << "Running the Cholesky Decomposition...";
+    clock.start();
+    rc = chol_factor(A, G);
+    clock.stop();
+    time = clock.getInterval();
+    if (rc != LINALG_OK) {
+        cout << "[NOT POSITIVE DEFINITE]" << endl;
+        return rc;
     }
+    cout << "[DONE]" << endl;
+    printf("Cholesky Decomposition running time is...[%f]\n", time);
 
-    for (i = 0; i < size; i++) {
-        for (j = 0; j < size; j++) {
-            if ((i == j && Identity[i][j] != 1) || (i != j && Identity[i][j] != 0)) {
-                return 1;
-            }
-        }
-    }
-    return 0;
+    cout << "Running the Cholesky inverse...";
+    clock.start();
+    rc = chol_inverse(G, Inv);
+    clock.stop();
+    time = clock.getInterval();
+    cout << "[DONE]" << endl;
+    printf("Cholesky inverse running time is...[%f]\n", time);
+    return rc;
 }
 
 /**
- * Main function
- * @param argc
- * @param argv
- * @return
+ * Inverse by LU Decomposition, the threads solving for their columns
+ * @param A
+ * @param Inv
+ * @param clock
+ * @return LINALG_SINGULAR when A is singular
  */
-int main(int argc, char *argv[]) {
-    Printer printer;
-    Clock clock;
+int lu_inverse(const Matrix &A, Matrix &Inv, Clock &clock) {
+    LUFactors F;
     int i,
+            n = A.rows,
             partition,
             rc;
     double time;
 
-    partition = matrix_size / num_threads;
+    partition = n / num_threads;
     pthread_t workers[num_threads];
     thread_data thread_data_array[num_threads];
-
-    /** Initialization */
-    cout << "Initializing...";
-    thread_data_array[num_threads - 1].lo = partition * (num_threads - 1);
-    thread_data_array[num_threads - 1].hi = matrix_size;
-    for (i = 0; i < num_threads - 1; i++) {
-        thread_data_array[i].hi = partition * (i + 1);
+    for (i = 0; i < num_threads; i++) {
+        thread_data_array[i].id = i;
         thread_data_array[i].lo = partition * i;
+        thread_data_array[i].hi = i == num_threads - 1 ? n : partition * (i + 1);
+        thread_data_array[i].F = &F;
+        thread_data_array[i].Inv = &Inv;
     }
-    populateVectorRandom(A, 0, 100, 2);
-    cout << "[DONE]" << endl;
 
     cout << "Running the LU Decomposition...";
     clock.start();
-    for (i = 0; i < matrix_size; i++)
-        Prow[i] = i;
-
-    LUDecomposition(A, L, U);
-
+#ifdef USE_PERF_COUNTERS
+    perf_region_init(&lu_region, "LU Decomposition");
+    perf_region_init(&substitution_region, "Forward and Backward Substitution");
+#ifdef _OPENMP
+    perf_region_begin(&lu_region);
+#else
+    perf_thread_start(&lu_region, 0);
+#endif
+#endif
+    rc = lu_factor(A, F);
+#ifdef USE_PERF_COUNTERS
+#ifdef _OPENMP
+    perf_region_end(&lu_region);
+#else
+    perf_thread_stop(&lu_region, 0);
+#endif
+#endif
     clock.stop();
     time = clock.getInterval();
+    if (rc == LINALG_SINGULAR) {
+        cout << "[SINGULAR]" << endl;
+        return rc;
+    }
     cout << "[DONE]" << endl;
     printf("LU Decomposition running time is...[%f]\n", time);
 
     cout << "Running the Forward and Backward Substitution...";
     clock.start();
-    int sum = 0;
-    for (i = 0; i < matrix_size; i++) {
-        Pcol[Prow[i]] = sum;
-        sum++;
-    }
-
-    pthread_create(&workers[num_threads - 1], NULL, triangle_inverse, &thread_data_array[num_threads - 1]);
-    for (i = 0; i < num_threads - 1; i++)
+    for (i = 0; i < num_threads; i++)
         pthread_create(&workers[i], NULL, triangle_inverse, &thread_data_array[i]);
     for (i = 0; i < num_threads; i++)
         pthread_join(workers[i], NULL);
-
     clock.stop();
     time = clock.getInterval();
     cout << "[DONE]" << endl;
     printf("Forward and Backward substitution running time is...[%f]\n", time);
+#ifdef USE_PERF_COUNTERS
+    perf_region_report(&lu_region, 2.0 / 3.0 * n * n * n);
+    perf_region_report(&substitution_region, 2.0 * n * n * n);
+#endif
+    return LINALG_OK;
+}
+
+/**
+ * Replace update_rows rows of A by random ones and update Inv to match
+ * @param A
+ * @param Inv
+ * @param clock
+ * @return LINALG_SINGULAR when the new matrix is singular
+ */
+int rows_update(Matrix &A, Matrix &Inv, Clock &clock) {
+    int k = min(update_rows, A.rows), rc;
+    vector<int> rows(k);
+    Matrix R(k, A.cols);
+    bool refactored;
+
+    for (int c = 0; c < k; c++)
+        rows[c] = (int) ((long) A.rows * c / k);
+    populateVectorRandom(R, 0, 100, 2);
+
+    cout << "Updating the inverse for " << k << " new rows...";
+    clock.start();
+    rc = inverse_update_rows(A, Inv, rows, R, &refactored);
+    clock.stop();
+    if (rc != LINALG_OK) {
+        cout << "[SINGULAR]" << endl;
+        return rc;
+    }
+    cout << (refactored ? "[DONE, INVERTED AGAIN]" : "[DONE]") << endl;
+    printf("Inverse update running time is...[%f]\n", clock.getInterval());
+    return LINALG_OK;
+}
+
+/**
+ * Main function
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char *argv[]) {
+    Printer printer;
+    Clock clock;
+    Matrix A(matrix_size, matrix_size), Inv(matrix_size, matrix_size);
+    bool spd = argc > 1 && string(argv[1]) == "spd";
+    int rc = LINALG_NOT_SPD;
+    double error;
+
+    /** Initialization */
+    cout << "Initializing...";
+    if (argc > 1 && !spd) {
+        if (readMatrix(argv[1], A) != LINALG_OK)
+            return 1;
+        Inv = Matrix(A.rows, A.cols);
+    } else if (spd) {
+        populateSPD(A, 0, 10);
+    } else {
+        populateVectorRandom(A, 0, 100, 2);
+    }
+    cout << "[DONE]" << endl;
+
+    if (is_symmetric(A))
+        rc = cholesky_inverse(A, Inv, clock);
+    if (rc != LINALG_OK && lu_inverse(A, Inv, clock) != LINALG_OK)
+        return 1;
 
 //    printer.print_matrix(A, "Matrix A is:\n");
 //    printer.print_matrix(Inv, "Matrix Inv is:\n");
     cout << "Checking the calculation result...";
-    rc = check(A, Inv, Identity);
-    if (rc == 0) {
+    error = inverse_error(A, Inv);
+    if (error < tolerance) {
         cout << "[CORRECT]" << endl;
     } else {
         cout << "[WRONG]" << endl;
     }
+    printf("Largest error of A * Inv - I is...[%g]\n", error);
+
+    if (rows_update(A, Inv, clock) != LINALG_OK)
+        return 1;
+    cout << "Checking the updated result...";
+    error = inverse_error(A, Inv);
+    cout << (error < tolerance ? "[CORRECT]" : "[WRONG]") << endl;
+    printf("Largest error of A * Inv - I is...[%g]\n", error);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,268 @@
+/**********************************
+ * DESCRIPTION: A distributed matrix-vector product with MPI and OpenMP, used for power
+ * iteration, unlike matrix-multiplication-openmp.cpp not bounded by one node's memory.
+ *
+ * Rank r owns a block of consecutive rows of A and the matching block of x and y. A product
+ * starts a non-blocking MPI_Iallgatherv of the blocks of x and meanwhile multiplies the
+ * diagonal block of its rows, which only needs its own block of x; the master thread calls
+ * MPI_Test between rows to push the gather on. After MPI_Wait the rest of the rows follow.
+ * The gathered x and the blocks of the iteration are allocated once and reused, so repeated
+ * products allocate nothing.
+ *
+ * The power iteration runs with the overlapped product and with a blocking MPI_Allgatherv
+ * before the whole product, and reports the time per product and the eigenvalue of both.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   COMPILE: mpicxx -std=c++11 -O3 -fopenmp matvec_mpi.cpp -o matvec_mpi
+ *   RUN: mpiexec -n < 4 or 8 > ./matvec_mpi [-n size] [-i iterations]
+ *   The matrix takes 8 n^2 bytes over all the ranks, 128 MB for the default n = 4096.
+ *
+ * USEFUL REFERENCE:
+ *    -> MPI: https://computing.llnl.gov/tutorials/mpi/
+ *    -> Power iteration: https://en.wikipedia.org/wiki/Power_iteration
+**********************************/
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <omp.h>
+#include <mpi.h>
+
+using namespace std;
+
+/**
+ * The rows of A owned by this rank, and the buffers reused by every product
+ */
+struct RowBlock {
+    int n;
+    int rows;                  // rows owned by this rank
+    int first;                 // global index of the first one
+    vector<int> counts;        // rows of every rank
+    vector<int> displs;
+    vector<double> a;          // rows x n, row major
+    vector<double> x;          // the gathered vector
+};
+
+/**
+ * Split n rows over the ranks and fill this rank's rows, every row from its own engine so
+ * the matrix does not depend on the number of ranks
+ */
+void setRowBlock(RowBlock &B, int n, int num_procs, int rank_id) {
+    B.n = n;
+    B.counts.resize(num_procs);
+    B.displs.resize(num_procs);
+    for (int r = 0, first = 0; r < num_procs; r++) {
+        B.counts[r] = n / num_procs + (r < n % num_procs);
+        B.displs[r] = first;
+        first += B.counts[r];
+    }
+    B.rows = B.counts[rank_id];
+    B.first = B.displs[rank_id];
+    B.a.resize((size_t) B.rows * n);
+    B.x.resize(n);
+
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < B.rows; i++) {
+        mt19937 engine(B.first + i + 1);
+        uniform_real_distribution<> u(0.0, 1.0);
+        double *row = &B.a[(size_t) i * n];
+        for (int j = 0; j < n; j++)
+            row[j] = u(engine);
+    }
+}
+
+/**
+ * y = A x with the gather of x overlapped with the diagonal block
+ * @param B
+ * @param x  this rank's block of x
+ * @param y  this rank's block of y
+ */
+void matvecOverlap(RowBlock &B, const double x[], double y[]) {
+    MPI_Request request;
+    int done = 0,
+            n = B.n,
+            first = B.first,
+            rows = B.rows;
+
+    MPI_Iallgatherv(x, rows, MPI_DOUBLE, B.x.data(), B.counts.data(), B.displs.data(), MPI_DOUBLE,
+                    MPI_COMM_WORLD, &request);
+
+#pragma omp parallel
+    {
+        /** Diagonal block, from the local block of x */
+#pragma omp for schedule(dynamic, 16)
+        for (int i = 0; i < rows; i++) {
+            const double *row = &B.a[(size_t) i * n + first];
+            double sum = 0.0;
+#pragma omp simd reduction(+:sum)
+            for (int j = 0; j < rows; j++)
+                sum += row[j] * x[j];
+            y[i] = sum;
+            if (omp_get_thread_num() == 0 && !done)
+                MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+        }
+
+#pragma omp master
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+#pragma omp barrier
+
+        /** The columns left and right of the diagonal block */
+        const double *gathered = B.x.data();
+#pragma omp for schedule(static)
+        for (int i = 0; i < rows; i++) {
+            const double *row = &B.a[(size_t) i * n];
+            double sum = 0.0;
+#pragma omp simd reduction(+:sum)
+            for (int j = 0; j < first; j++)
+                sum += row[j] * gathered[j];
+#pragma omp simd reduction(+:sum)
+            for (int j = first + rows; j < n; j++)
+                sum += row[j] * gathered[j];
+            y[i] += sum;
+        }
+    }
+}
+
+/**
+ * y = A x, gathering all of x first
+ * @param B
+ * @param x  this rank's block of x
+ * @param y  this rank's block of y
+ */
+void matvecBlocking(RowBlock &B, const double x[], double y[]) {
+    int n = B.n;
+
+    MPI_Allgatherv(x, B.rows, MPI_DOUBLE, B.x.data(), B.counts.data(), B.displs.data(), MPI_DOUBLE,
+                   MPI_COMM_WORLD);
+    const double *gathered = B.x.data();
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < B.rows; i++) {
+        const double *row = &B.a[(size_t) i * n];
+        double sum = 0.0;
+#pragma omp simd reduction(+:sum)
+        for (int j = 0; j < n; j++)
+            sum += row[j] * gathered[j];
+        y[i] = sum;
+    }
+}
+
+/**
+ * Dot product of two distributed vectors
+ */
+double dot(const vector<double> &u, const vector<double> &v) {
+    double local = 0.0, global;
+#pragma omp parallel for reduction(+:local)
+    for (size_t i = 0; i < u.size(); i++)
+        local += u[i] * v[i];
+    MPI_Allreduce(&local, &global, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    return global;
+}
+
+/**
+ * Power iteration from the normalized vector of ones
+ * @param B
+ * @param iterations
+ * @param matvec
+ * @param lambda    set to the estimate of the dominant eigenvalue
+ * @param residual  set to |A x - lambda x| / |lambda|
+ * @return the slowest rank's time per product
+ */
+double powerIteration(RowBlock &B, int iterations, void (*matvec)(RowBlock &, const double *, double *),
+                      double &lambda, double &residual) {
+    vector<double> x(B.rows, 1.0 / sqrt((double) B.n)), y(B.rows);
+    double time = 0.0, max_time;
+
+    for (int k = 0; k < iterations; k++) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        double start = MPI_Wtime();
+        matvec(B, x.data(), y.data());
+        time += MPI_Wtime() - start;
+
+        double norm = sqrt(dot(y, y));
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < B.rows; i++)
+            x[i] = y[i] / norm;
+    }
+
+    /** Rayleigh quotient and residual of the last vector */
+    matvec(B, x.data(), y.data());
+    lambda = dot(x, y);
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < B.rows; i++)
+        y[i] -= lambda * x[i];
+    residual = sqrt(dot(y, y)) / fabs(lambda);
+
+    MPI_Reduce(&time, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    return max_time / max(iterations, 1);
+}
+
+/**
+ * Main function
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char *argv[]) {
+    int rank_id,
+            num_procs,
+            provided,
+            n = 4096,
+            iterations = 50,
+            opt;
+    double lambda[2],
+            residual[2],
+            time[2];
+
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank_id);
+
+    while ((opt = getopt(argc, argv, "n:i:")) != -1) {
+        switch (opt) {
+            case 'n':
+                n = atoi(optarg);
+                break;
+            case 'i':
+                iterations = atoi(optarg);
+                break;
+            default:
+                if (rank_id == 0)
+                    fprintf(stderr, "Usage: %s [-n size] [-i iterations]\n", argv[0]);
+                MPI_Finalize();
+                return 1;
+        }
+    }
+    if (n < num_procs || iterations < 1) {
+        if (rank_id == 0)
+            fprintf(stderr, "The size must be at least the number of ranks, the iterations positive\n");
+        MPI_Finalize();
+        return 1;
+    }
+
+    RowBlock B;
+    setRowBlock(B, n, num_procs, rank_id);
+
+    time[0] = powerIteration(B, iterations, matvecBlocking, lambda[0], residual[0]);
+    time[1] = powerIteration(B, iterations, matvecOverlap, lambda[1], residual[1]);
+
+    if (rank_id == 0) {
+        const char *names[] = {"blocking", "overlapped"};
+        printf("Ranks: %d, threads per rank: %d, size: %d, iterations: %d\n",
+               num_procs, omp_get_max_threads(), n, iterations);
+        printf("%-12s %14s %10s %18s %12s\n", "product", "time/prod(ms)", "GFLOP/s", "eigenvalue", "residual");
+        for (int m = 0; m < 2; m++)
+            printf("%-12s %14.3f %10.2f %18.8f %12.2e\n", names[m], time[m] * 1e3,
+                   2.0 * n * n / time[m] * 1e-9, lambda[m], residual[m]);
+        printf("Checking the calculation result...%s\n",
+               fabs(lambda[0] - lambda[1]) <= 1e-9 * fabs(lambda[0]) ? "[CORRECT]" : "[WRONG]");
+    }
+
+    MPI_Finalize();
+    return 0;
+}
@@ -1,7 +1,39 @@
+/**********************************
+ * DESCRIPTION: A memory bandwidth benchmark for a serial and an OpenMP parallel loop.
+ *
+ * The arrays live on the heap and are initialized by the same static schedule as the timed
+ * loop (parallel first touch), so on a NUMA machine every thread streams from its own node.
+ * "-t serial" initializes them from the master thread instead, placing every page on one
+ * node, which shows the NUMA penalty. The array size is swept across L1/L2/L3/DRAM and each
+ * size reports the best of several repetitions in GB/s, after a warm-up run.
+ *
+ * Thread pinning follows OMP_PROC_BIND/OMP_PLACES. The OpenMP runtime reads them once at
+ * start-up, so the "-b" and "-p" presets set them and re-execute the program.
+ *
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   COMPILE: gcc -O3 -march=native -fopenmp omp_parfor.c -o omp_parfor
+ *   RUN: ./omp_parfor [-b false|true|master|close|spread] [-p threads|cores|sockets]
+ *                     [-t serial|parallel] [-m max_bytes]
+ *
+ * USEFUL REFERENCE:
+ *    -> OpenMP affinity: https://www.openmp.org/spec-html/5.0/openmpse52.html
+**********************************/
+#define _GNU_SOURCE
 #include <omp.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
 #include <time.h>
 
+#define MIN_BYTES (4UL << 10)
+#define MAX_BYTES (1UL << 30)
+#define BYTES_PER_REPEAT (1UL << 30)
+#define MIN_REPEATS 5
+
 double CLOCK()
 {
     struct timespec t;
@@ -9,47 +41,184 @@ double CLOCK()
     return (t.tv_sec * 1000) + (t.tv_nsec * 1e-6);
 }
 
-main(int argc, char **argv)
+/**
+ * Set the binding environment and re-execute, since the runtime has already read it
+ */
+void apply_binding(char **argv, const char *bind, const char *places)
+{
+    const char *cur_bind = getenv("OMP_PROC_BIND");
+    const char *cur_places = getenv("OMP_PLACES");
+
+    if ((bind == NULL || (cur_bind && strcmp(cur_bind, bind) == 0)) &&
+        (places == NULL || (cur_places && strcmp(cur_places, places) == 0)))
+        return;
+
+    if (bind)
+        setenv("OMP_PROC_BIND", bind, 1);
+    if (places)
+        setenv("OMP_PLACES", places, 1);
+    execv("/proc/self/exe", argv);
+    perror("execv");
+}
+
+const char *bind_name(omp_proc_bind_t bind)
+{
+    switch (bind)
+    {
+    case omp_proc_bind_false:
+        return "false";
+    case omp_proc_bind_true:
+        return "true";
+    case omp_proc_bind_master:
+        return "master";
+    case omp_proc_bind_close:
+        return "close";
+    case omp_proc_bind_spread:
+        return "spread";
+    }
+    return "unknown";
+}
+
+void print_binding()
 {
-    unsigned int i;
-    double start, finish, total1, total2, total3;
-    double a[1000000];
+    int t;
+
+    printf("Threads: %d, proc bind: %s, places: %d (OMP_PLACES=%s)\n",
+           omp_get_max_threads(), bind_name(omp_get_proc_bind()), omp_get_num_places(),
+           getenv("OMP_PLACES") ? getenv("OMP_PLACES") : "unset");
 
-    start = CLOCK();
-    //    #pragma omp for
-    for (i = 0; i < 1000000; i++)
+#pragma omp parallel
     {
-        a[i] = 2.0 * i;
-        a[i] += (i % 3);
+#pragma omp for ordered schedule(static, 1)
+        for (t = 0; t < omp_get_num_threads(); t++)
+        {
+#pragma omp ordered
+            printf("  thread %d: place %d, cpu %d\n", t, omp_get_place_num(), sched_getcpu());
+        }
     }
-    finish = CLOCK();
-    total1 = finish - start;
+}
 
-    start = CLOCK();
-#pragma omp parallel for
-    for (i = 0; i < 1000000; i++)
+/**
+ * The timed kernel, reading a and b and writing a (24 bytes per element)
+ */
+void update_serial(double *a, const double *b, unsigned long n)
+{
+    unsigned long i;
+    for (i = 0; i < n; i++)
     {
-        a[i] = 2.0 * i;
-        a[i] += (i % 3);
+        a[i] += 2.0 * b[i];
     }
-    finish = CLOCK();
-    total2 = finish - start;
+}
 
-    start = CLOCK();
-    for (i = 0; i < 1000000; i++)
+void update_parallel(double *a, const double *b, unsigned long n)
+{
+    long i;
+#pragma omp parallel for schedule(static)
+    for (i = 0; i < (long) n; i++)
     {
-        a[i] = 2.0 * i;
-        a[i] += (i % 3);
+        a[i] += 2.0 * b[i];
     }
-    finish = CLOCK();
-    total3 = finish - start;
+}
 
-    //for (i=0; i<1000000; i++)
-    //    printf("The value for a[%li] = %f\n", i, a[i]);
+/**
+ * Best time in ms of the kernel over enough repetitions to stream BYTES_PER_REPEAT
+ */
+double time_kernel(void (*kernel)(double *, const double *, unsigned long),
+                   double *a, const double *b, unsigned long n)
+{
+    unsigned long repeats = BYTES_PER_REPEAT / (n * 3 * sizeof(double)), r;
+    double start, finish, best = 1e30;
 
-    printf("Time for first loop = %f\n", total1);
-    printf("Time for second loop = %f\n", total2);
-    printf("Time for third loop = %f\n", total3);
+    if (repeats < MIN_REPEATS)
+        repeats = MIN_REPEATS;
+
+    kernel(a, b, n);
+    for (r = 0; r < repeats; r++)
+    {
+        start = CLOCK();
+        kernel(a, b, n);
+        finish = CLOCK();
+        if (finish - start < best)
+            best = finish - start;
+    }
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    const char *bind = NULL, *places = NULL;
+    unsigned long max_bytes = MAX_BYTES, bytes, n;
+    int parallel_touch = 1, opt;
+    double total1, total2;
+
+    while ((opt = getopt(argc, argv, "b:p:t:m:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            bind = optarg;
+            break;
+        case 'p':
+            places = optarg;
+            break;
+        case 't':
+            parallel_touch = strcmp(optarg, "serial") != 0;
+            break;
+        case 'm':
+            max_bytes = (unsigned long) strtod(optarg, NULL);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-b bind] [-p places] [-t serial|parallel] [-m max_bytes]\n", argv[0]);
+            return 1;
+        }
+    }
+    apply_binding(argv, bind, places);
+    print_binding();
+    printf("First touch: %s\n\n", parallel_touch ? "parallel" : "serial");
+
+    printf("%14s %16s %16s %10s\n", "array bytes", "serial GB/s", "parallel GB/s", "speedup");
+    for (bytes = MIN_BYTES; bytes <= max_bytes; bytes *= 2)
+    {
+        double *a, *b;
+        long i;
+
+        n = bytes / sizeof(double);
+        a = aligned_alloc(64, n * sizeof(double));
+        b = aligned_alloc(64, n * sizeof(double));
+        if (a == NULL || b == NULL)
+        {
+            fprintf(stderr, "Cannot allocate %lu bytes\n", bytes);
+            return 1;
+        }
+
+        /** First touch places each page on the node of the thread that writes it */
+        if (parallel_touch)
+        {
+#pragma omp parallel for schedule(static)
+            for (i = 0; i < (long) n; i++)
+            {
+                a[i] = 2.0 * i;
+                b[i] = i % 3;
+            }
+        }
+        else
+        {
+            for (i = 0; i < (long) n; i++)
+            {
+                a[i] = 2.0 * i;
+                b[i] = i % 3;
+            }
+        }
+
+        total1 = time_kernel(update_serial, a, b, n);
+        total2 = time_kernel(update_parallel, a, b, n);
+
+        printf("%14lu %16.2f %16.2f %10.2f\n", bytes,
+               3.0 * bytes / total1 * 1e-6, 3.0 * bytes / total2 * 1e-6, total1 / total2);
+
+        free(a);
+        free(b);
+    }
 
     return 0;
 }
@@ -1,6 +1,13 @@
+/*
+ * Add -DUSE_PERF_COUNTERS to report the perf_event counters of the product (perf_counters.h).
+ */
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <sys/time.h>
+#ifdef USE_PERF_COUNTERS
+#include "perf_counters.h"
+#endif
 #define dt(start, end) ((end.tv_sec - start.tv_sec) + \
                         1 / 1000000.0 * (end.tv_usec - start.tv_usec))
 
@@ -39,6 +46,11 @@ int main()
     }
   }
 
+#ifdef USE_PERF_COUNTERS
+  static perf_region_t region;
+  perf_region_init(&region, "matmul");
+  perf_region_begin(&region);
+#endif
   gettimeofday(&scalc, NULL);
 #pragma omp parallel for private(sum, i, k, j)
   for (i = 0; i < nra; i++)
@@ -55,6 +67,13 @@ int main()
   }
 
   gettimeofday(&ecalc, NULL);
+#ifdef USE_PERF_COUNTERS
+  perf_region_end(&region);
+#endif
+
   timing = dt(scalc, ecalc);
   printf("Init Time: %6.3f Calc Time: %6.3f GFlops: %7.3f\n", dt(icalc, scalc), timing, 1e-9 * flops / timing);
+#ifdef USE_PERF_COUNTERS
+  perf_region_report(&region, flops);
+#endif
 }
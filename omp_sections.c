@@ -1,20 +1,51 @@
+/******************************************************************************
+ * * FILE: omp_sections.c
+ * * DESCRIPTION:
+ * *   Static parallel sections against dependency-driven tasks.
+ * *   Without arguments work1..work4 run once as parallel sections, where the
+ * *   second section serializes work2 and work3, and once as tasks declaring
+ * *   what they produce and consume with depend(in/out), so only work3 waits.
+ * *
+ * *   With "bench" an unbalanced DAG of synthetic work is run three ways:
+ * *     sections - level by level, each level split statically into
+ * *                NUM_SECTIONS sections with a barrier in between
+ * *     depend   - one task per node, edges given as depend(in/out) clauses
+ * *     counter  - one task per node, spawned by the predecessor which brings
+ * *                its count of pending inputs to zero
+ * *
+ * * USAGE: gcc -O3 -fopenmp omp_sections.c -o omp_sections
+ * *        ./omp_sections [bench]
+ * * LAST REVISED: 10/18/2026
+ * ******************************************************************************/
 #include <omp.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LEVELS 6
+#define WIDTH 8
+#define NUM_NODES (LEVELS * WIDTH)
+#define MAX_DEPS 4
+#define MAX_SUCC WIDTH
+#define NUM_SECTIONS 4
+#define REPEATS 5
 
 int work1()
 {
   int j, tid;
   tid = omp_get_thread_num();
   for (j = 0; j < 10; j++)
-    printf("The value of j as printed by work 1, thread %li = %li\n", tid, j);
+    printf("The value of j as printed by work 1, thread %d = %d\n", tid, j);
+  return 0;
 }
 int work2()
 {
   int j, tid;
   tid = omp_get_thread_num();
   for (j = 0; j < 10; j++)
-    printf("The value of j as printed by work 2, thread %li = %li\n", tid, j);
+    printf("The value of j as printed by work 2, thread %d = %d\n", tid, j);
+  return 0;
 }
 int work3()
 {
@@ -23,6 +54,7 @@ int work3()
   printf("Work 3\n");
   printf("Work 3\n");
   printf("Work 3\n");
+  return 0;
 }
 int work4()
 {
@@ -31,10 +63,229 @@ int work4()
   printf("Work 4\n");
   printf("Work 4\n");
   printf("Work 4\n");
+  return 0;
+}
+
+typedef struct
+{
+  double cost;           /* CPU seconds of synthetic work */
+  int num_deps;
+  int deps[MAX_DEPS];
+  int num_succ;
+  int succ[MAX_SUCC];
+  int pending;           /* inputs not produced yet, counter executor only */
+} node_t;
+
+node_t graph[NUM_NODES];
+char tokens[NUM_NODES + 1]; /* depend() addresses, tokens[NUM_NODES] is never written */
+
+/**
+ * Burn CPU time rather than wall time, so oversubscribed threads do their full share
+ */
+void spin(double seconds)
+{
+  struct timespec t;
+  double start;
+
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+  start = t.tv_sec + t.tv_nsec * 1e-9;
+  do
+  {
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+  } while (t.tv_sec + t.tv_nsec * 1e-9 - start < seconds);
+}
+
+/**
+ * Levels of WIDTH nodes, each depending on one to MAX_DEPS nodes of the previous level.
+ * One node in every level is 10x heavier, and it moves around so that no static split is
+ * balanced.
+ */
+void build_graph()
+{
+  unsigned int seed = 7;
+  int level, j, k, id;
+
+  memset(graph, 0, sizeof(graph));
+  for (level = 0; level < LEVELS; level++)
+  {
+    for (j = 0; j < WIDTH; j++)
+    {
+      id = level * WIDTH + j;
+      graph[id].cost = j == (level * 3) % WIDTH ? 0.020 : 0.002;
+      if (level == 0)
+        continue;
+      graph[id].num_deps = 1 + rand_r(&seed) % MAX_DEPS;
+      for (k = 0; k < graph[id].num_deps; k++)
+      {
+        int dep = (level - 1) * WIDTH + (j + k) % WIDTH;
+        graph[id].deps[k] = dep;
+        graph[dep].succ[graph[dep].num_succ++] = id;
+      }
+    }
+  }
+}
+
+/**
+ * Longest path, the lower bound of any schedule
+ */
+double critical_path()
+{
+  double finish[NUM_NODES], best = 0;
+  int i, k;
+
+  for (i = 0; i < NUM_NODES; i++)
+  {
+    double ready = 0;
+    for (k = 0; k < graph[i].num_deps; k++)
+      if (finish[graph[i].deps[k]] > ready)
+        ready = finish[graph[i].deps[k]];
+    finish[i] = ready + graph[i].cost;
+    if (finish[i] > best)
+      best = finish[i];
+  }
+  return best;
+}
+
+/**
+ * Static sections: section s of a level runs the nodes s, s + NUM_SECTIONS, ... in order
+ */
+void run_lane(int level, int lane)
+{
+  int j;
+  for (j = lane; j < WIDTH; j += NUM_SECTIONS)
+    spin(graph[level * WIDTH + j].cost);
+}
+
+void run_sections()
+{
+  int level;
+  for (level = 0; level < LEVELS; level++)
+  {
+#pragma omp parallel sections
+    {
+      run_lane(level, 0);
+#pragma omp section
+      run_lane(level, 1);
+#pragma omp section
+      run_lane(level, 2);
+#pragma omp section
+      run_lane(level, 3);
+    }
+  }
+}
+
+/**
+ * Tasks with depend clauses: created in topological order by one thread, unused
+ * dependence slots point at a token nobody writes
+ */
+void run_depend()
+{
+#pragma omp parallel
+#pragma omp single
+  {
+    int i, k;
+    for (i = 0; i < NUM_NODES; i++)
+    {
+      char *d[MAX_DEPS];
+      for (k = 0; k < MAX_DEPS; k++)
+        d[k] = &tokens[k < graph[i].num_deps ? graph[i].deps[k] : NUM_NODES];
+#pragma omp task firstprivate(i) depend(in: *d[0], *d[1], *d[2], *d[3]) depend(out: tokens[i])
+      spin(graph[i].cost);
+    }
+  }
+}
+
+/**
+ * Counter executor: the predecessor which finishes last spawns the successor
+ */
+void run_node(int id)
+{
+  int k, left;
+
+  spin(graph[id].cost);
+  for (k = 0; k < graph[id].num_succ; k++)
+  {
+    int next = graph[id].succ[k];
+#pragma omp atomic capture
+    left = --graph[next].pending;
+    if (left == 0)
+    {
+#pragma omp task firstprivate(next)
+      run_node(next);
+    }
+  }
+}
+
+void run_counter()
+{
+  int i;
+
+  for (i = 0; i < NUM_NODES; i++)
+    graph[i].pending = graph[i].num_deps;
+
+#pragma omp parallel
+#pragma omp single
+  {
+    for (i = 0; i < NUM_NODES; i++)
+      if (graph[i].num_deps == 0)
+      {
+#pragma omp task firstprivate(i)
+        run_node(i);
+      }
+  }
+}
+
+double best_time(void (*run)())
+{
+  double best = 1e30, start;
+  int r;
+
+  for (r = 0; r < REPEATS; r++)
+  {
+    start = omp_get_wtime();
+    run();
+    start = omp_get_wtime() - start;
+    if (start < best)
+      best = start;
+  }
+  return best;
+}
+
+void bench()
+{
+  double work = 0, sections, depend, counter;
+  int i;
+
+  build_graph();
+  for (i = 0; i < NUM_NODES; i++)
+    work += graph[i].cost;
+
+  printf("DAG: %d levels x %d nodes, total work %.3f s, critical path %.3f s, threads %d\n",
+         LEVELS, WIDTH, work, critical_path(), omp_get_max_threads());
+  printf("Lower bound with %d threads: %.3f s\n\n", omp_get_max_threads(),
+         work / omp_get_max_threads() > critical_path() ? work / omp_get_max_threads() : critical_path());
+
+  sections = best_time(run_sections);
+  depend = best_time(run_depend);
+  counter = best_time(run_counter);
+
+  printf("%-10s %10s %10s\n", "mode", "time(s)", "speedup");
+  printf("%-10s %10.3f %10.2f\n", "sections", sections, 1.0);
+  printf("%-10s %10.3f %10.2f\n", "depend", depend, sections / depend);
+  printf("%-10s %10.3f %10.2f\n", "counter", counter, sections / counter);
 }
 
-main()
+int main(int argc, char *argv[])
 {
+  int t2 = 0;
+
+  if (argc > 1 && strcmp(argv[1], "bench") == 0)
+  {
+    bench();
+    return 0;
+  }
+
+  printf("**************** Sections ****************\n");
 #pragma omp parallel sections
   {
     work1();
@@ -48,4 +299,19 @@ main()
       work4();
     }
   }
+
+  printf("**************** Tasks ****************\n");
+#pragma omp parallel
+#pragma omp single
+  {
+#pragma omp task
+    work1();
+#pragma omp task shared(t2) depend(out: t2)
+    t2 = work2();
+#pragma omp task depend(in: t2)
+    work3();
+#pragma omp task
+    work4();
+  }
+  return 0;
 }
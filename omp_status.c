@@ -1,8 +1,70 @@
+/******************************************************************************
+ * * FILE: omp_status.c
+ * * DESCRIPTION:
+ * *   Reports the OpenMP environment of the runtime, the topology of the node
+ * *   (CPU affinity of every thread, caches, NUMA nodes, SIMD support, bound
+ * *   places), measures the fork/join, barrier and atomic costs, and recommends
+ * *   thread counts and bind policies for the programs of this collection.
+ * *   Topology comes from /sys on Linux and is skipped where it is missing.
+ * *
+ * * USAGE: gcc -O2 -fopenmp omp_status.c -o omp_status
+ * * LAST REVISED: 10/18/2026
+ * ******************************************************************************/
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sched.h>
 #include <omp.h>
 
-int main(int argc, char *argv[])
+#define PROBE_REPEATS 2000
+#define MAX_CORES 4096
+
+volatile int probe_sink;
+
+/**
+ * Read the first line of a sysfs file, 0 when it does not exist
+ */
+int read_line(const char *path, char *buf, int size)
+{
+  FILE *f = fopen(path, "r");
+  if (f == NULL)
+    return 0;
+  if (fgets(buf, size, f) == NULL)
+  {
+    fclose(f);
+    return 0;
+  }
+  fclose(f);
+  buf[strcspn(buf, "\n")] = '\0';
+  return 1;
+}
+
+/**
+ * Format a CPU set as a list of ranges, "0-3,8-11"
+ */
+void format_cpuset(cpu_set_t *set, char *buf, int size)
+{
+  int cpu, first = -1, len = 0;
+
+  buf[0] = '\0';
+  for (cpu = 0; cpu <= CPU_SETSIZE; cpu++)
+  {
+    int in = cpu < CPU_SETSIZE && CPU_ISSET(cpu, set);
+    if (in && first < 0)
+      first = cpu;
+    if (!in && first >= 0)
+    {
+      if (len < size)
+        len += snprintf(buf + len, size - len, len ? ",%d" : "%d", first);
+      if (cpu - 1 > first && len < size)
+        len += snprintf(buf + len, size - len, "-%d", cpu - 1);
+      first = -1;
+    }
+  }
+}
+
+void report_environment()
 {
   int nthreads, tid, procs, maxt, inpar, dynamic, nested;
 
@@ -24,7 +86,7 @@ int main(int argc, char *argv[])
       maxt = omp_get_max_threads();
       inpar = omp_in_parallel();
       dynamic = omp_get_dynamic();
-      nested = omp_get_nested();
+      nested = omp_get_max_active_levels() > 1;
 
       /* Print environment information */
       printf("Number of processors = %d\n", procs);
@@ -36,3 +98,245 @@ int main(int argc, char *argv[])
     }
   }
 }
+
+void report_affinity()
+{
+  const char *binds[] = {"false", "true", "master", "close", "spread"};
+  int bind = omp_get_proc_bind(), p, t;
+
+  printf("\nProc bind = %s, places = %d (OMP_PLACES=%s)\n",
+         bind >= 0 && bind <= 4 ? binds[bind] : "unknown", omp_get_num_places(),
+         getenv("OMP_PLACES") ? getenv("OMP_PLACES") : "unset");
+  for (p = 0; p < omp_get_num_places(); p++)
+  {
+    /* omp_get_place_proc_ids writes all the ids of the place */
+    int n = omp_get_place_num_procs(p), i;
+    int *ids = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (ids == NULL)
+      continue;
+    omp_get_place_proc_ids(p, ids);
+    printf("  place %d: {", p);
+    for (i = 0; i < n; i++)
+      printf(i ? ",%d" : "%d", ids[i]);
+    printf("}\n");
+    free(ids);
+  }
+
+#pragma omp parallel
+  {
+#pragma omp for ordered schedule(static, 1)
+    for (t = 0; t < omp_get_num_threads(); t++)
+    {
+      cpu_set_t set;
+      char list[256] = "unknown";
+      CPU_ZERO(&set);
+      if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        format_cpuset(&set, list, sizeof(list));
+#pragma omp ordered
+      printf("  thread %d: on cpu %d, place %d, affinity {%s}\n",
+             t, sched_getcpu(), omp_get_place_num(), list);
+    }
+  }
+}
+
+/**
+ * Caches of cpu0, and the number of physical cores and sockets
+ */
+void report_topology(int *cores, int *sockets, int *numa_nodes, long *llc_bytes)
+{
+  char path[128], level[16], type[32], size[32], shared[64];
+  static int seen[MAX_CORES];
+  int i, cpu;
+
+  printf("\nCaches:\n");
+  *llc_bytes = 0;
+  for (i = 0; i < 8; i++)
+  {
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", i);
+    if (!read_line(path, level, sizeof(level)))
+      break;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", i);
+    read_line(path, type, sizeof(type));
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", i);
+    read_line(path, size, sizeof(size));
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/shared_cpu_list", i);
+    if (!read_line(path, shared, sizeof(shared)))
+      strcpy(shared, "?");
+    printf("  L%s %-12s %10s shared by cpus %s\n", level, type, size, shared);
+    *llc_bytes = atol(size) * (strchr(size, 'M') ? 1048576L : 1024L);
+  }
+  if (i == 0)
+    printf("  unknown\n");
+
+  /** A core is a distinct (package, core id) pair */
+  *cores = 0;
+  *sockets = 0;
+  for (cpu = 0; cpu < MAX_CORES; cpu++)
+  {
+    char pkg[16], core[16];
+    int key;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+    if (!read_line(path, pkg, sizeof(pkg)))
+      break;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+    read_line(path, core, sizeof(core));
+    if (atoi(pkg) + 1 > *sockets)
+      *sockets = atoi(pkg) + 1;
+    key = (atoi(pkg) * 1024 + atoi(core)) % MAX_CORES;
+    if (!seen[key])
+    {
+      seen[key] = 1;
+      (*cores)++;
+    }
+  }
+  if (*cores == 0)
+  {
+    *cores = omp_get_num_procs();
+    *sockets = 1;
+  }
+  printf("\nSockets = %d, physical cores = %d, hardware threads = %d\n",
+         *sockets, *cores, omp_get_num_procs());
+
+  printf("\nNUMA nodes:\n");
+  *numa_nodes = 0;
+  for (i = 0; i < 1024; i++)
+  {
+    char cpus[256];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", i);
+    if (!read_line(path, cpus, sizeof(cpus)))
+      continue;
+    printf("  node %d: cpus %s\n", i, cpus);
+    (*numa_nodes)++;
+  }
+  if (*numa_nodes == 0)
+  {
+    printf("  unknown, assuming one\n");
+    *numa_nodes = 1;
+  }
+}
+
+void report_simd()
+{
+  printf("\nSIMD support:");
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.2"))
+    printf(" sse4.2");
+  if (__builtin_cpu_supports("avx"))
+    printf(" avx");
+  if (__builtin_cpu_supports("avx2"))
+    printf(" avx2");
+  if (__builtin_cpu_supports("fma"))
+    printf(" fma");
+  if (__builtin_cpu_supports("avx512f"))
+    printf(" avx512f");
+  if (__builtin_cpu_supports("avx512vpopcntdq"))
+    printf(" avx512vpopcntdq");
+  if (__builtin_cpu_supports("popcnt"))
+    printf(" popcnt");
+  printf("\n");
+#elif defined(__ARM_NEON)
+  printf(" neon\n");
+#else
+  printf(" unknown\n");
+#endif
+}
+
+/**
+ * Micro-probes, all in microseconds per operation
+ */
+double probe_fork_join(int threads)
+{
+  double start;
+  int r;
+
+  for (r = 0; r < 10; r++)
+  {
+#pragma omp parallel num_threads(threads)
+    probe_sink = omp_get_thread_num();
+  }
+  start = omp_get_wtime();
+  for (r = 0; r < PROBE_REPEATS; r++)
+  {
+#pragma omp parallel num_threads(threads)
+    probe_sink = omp_get_thread_num();
+  }
+  return (omp_get_wtime() - start) / PROBE_REPEATS * 1e6;
+}
+
+double probe_barrier(int threads)
+{
+  double start = 0, stop = 0;
+
+#pragma omp parallel num_threads(threads)
+  {
+    int r;
+#pragma omp barrier
+#pragma omp master
+    start = omp_get_wtime();
+    for (r = 0; r < PROBE_REPEATS; r++)
+    {
+#pragma omp barrier
+    }
+#pragma omp master
+    stop = omp_get_wtime();
+  }
+  return (stop - start) / PROBE_REPEATS * 1e6;
+}
+
+double probe_atomic(int threads)
+{
+  long counter = 0;
+  double start = omp_get_wtime();
+
+#pragma omp parallel num_threads(threads)
+  {
+    int r;
+    for (r = 0; r < PROBE_REPEATS * 10; r++)
+    {
+#pragma omp atomic
+      counter++;
+    }
+  }
+  return (omp_get_wtime() - start) / (PROBE_REPEATS * 10.0 * threads) * 1e6;
+}
+
+int main()
+{
+  int cores, sockets, numa_nodes, t, max_threads = omp_get_max_threads();
+  long llc_bytes;
+  double fork_join = 0;
+
+  report_environment();
+  report_affinity();
+  report_topology(&cores, &sockets, &numa_nodes, &llc_bytes);
+  report_simd();
+
+  printf("\nMicro-probes (us per operation):\n");
+  printf("%8s %12s %12s %12s\n", "threads", "fork/join", "barrier", "atomic");
+  for (t = 1;; t *= 2)
+  {
+    if (t > max_threads)
+      t = max_threads;
+    fork_join = probe_fork_join(t);
+    printf("%8d %12.3f %12.3f %12.4f\n", t, fork_join, probe_barrier(t), probe_atomic(t));
+    if (t == max_threads)
+      break;
+  }
+
+  printf("\nRecommendations:\n");
+  printf("  Memory-bound kernels (stream, omp_parfor, mat-vec): OMP_NUM_THREADS=%d OMP_PLACES=cores OMP_PROC_BIND=spread\n",
+         cores);
+  printf("  Compute-bound kernels (matmul, LU): OMP_NUM_THREADS=%d OMP_PLACES=%s OMP_PROC_BIND=close\n",
+         omp_get_num_procs(), omp_get_num_procs() > cores ? "threads" : "cores");
+  if (numa_nodes > 1)
+    printf("  %d NUMA nodes: initialize data in parallel with the same schedule as the kernel (first touch)\n",
+           numa_nodes);
+  if (omp_get_num_places() == 0)
+    printf("  Threads are not bound, so they may migrate between cores; set OMP_PROC_BIND\n");
+  printf("  A parallel region should do at least %.0f us of work to keep fork/join overhead under 1%%\n",
+         fork_join * 100);
+  if (llc_bytes > 0)
+    printf("  Working sets under %.1f MiB stay in the last level cache\n", llc_bytes / 1048576.0);
+  return 0;
+}
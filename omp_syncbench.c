@@ -0,0 +1,303 @@
+/******************************************************************************
+ * * FILE: omp_syncbench.c
+ * * DESCRIPTION:
+ * *   Synchronization overhead benchmark grown from omp_hello.c, following the
+ * *   EPCC OpenMP micro-benchmark method. Each construct wraps a short delay
+ * *   loop and is executed innerreps times; its overhead is the difference to
+ * *   the same delays without the construct, divided by innerreps. Every test
+ * *   is repeated OUTER_REPS times, outliers further than 3 median absolute
+ * *   deviations from the median are rejected, and the median and mean of the
+ * *   rest are reported for thread counts doubling up to the maximum.
+ * *
+ * *   The parallel + for overhead is the minimum useful grain size: a region
+ * *   should do about 100x that much work for a 1% overhead.
+ * *
+ * * USAGE: gcc -O2 -fopenmp omp_syncbench.c -o omp_syncbench -lm
+ * *        ./omp_syncbench [delay_us]
+ * * LAST REVISED: 10/18/2026
+ * ******************************************************************************/
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define OUTER_REPS 20
+#define TARGET_SECONDS 1e-3
+#define MAX_INNER_REPS (1 << 24)
+#define NUM_TESTS 8
+
+int delay_length;
+omp_lock_t lock;
+double shared_sum;
+
+/**
+ * Busy work which the compiler cannot remove, about delay_us long once calibrated
+ */
+void delay(int length)
+{
+  int i;
+  double a = 0.0;
+  for (i = 0; i < length; i++)
+    a += i;
+  if (a < 0)
+    printf("%f\n", a);
+}
+
+void calibrate(double delay_us)
+{
+  double start, elapsed;
+  int reps = 1000, r;
+
+  delay_length = 1;
+  do
+  {
+    delay_length *= 2;
+    start = omp_get_wtime();
+    for (r = 0; r < reps; r++)
+      delay(delay_length);
+    elapsed = (omp_get_wtime() - start) / reps;
+  } while (elapsed < delay_us * 1e-6);
+  delay_length = (int) (delay_length * delay_us * 1e-6 / elapsed);
+  if (delay_length < 1)
+    delay_length = 1;
+}
+
+/**
+ * Tests run innerreps instances of the construct; the reference runs the same delays
+ */
+void test_reference(int innerreps)
+{
+  int j;
+  for (j = 0; j < innerreps; j++)
+    delay(delay_length);
+}
+
+void test_parallel(int innerreps)
+{
+  int j;
+  for (j = 0; j < innerreps; j++)
+  {
+#pragma omp parallel
+    delay(delay_length);
+  }
+}
+
+void test_for(int innerreps)
+{
+#pragma omp parallel
+  {
+    int i, j, n = omp_get_num_threads();
+    for (j = 0; j < innerreps; j++)
+    {
+#pragma omp for
+      for (i = 0; i < n; i++)
+        delay(delay_length);
+    }
+  }
+}
+
+void test_barrier(int innerreps)
+{
+#pragma omp parallel
+  {
+    int j;
+    for (j = 0; j < innerreps; j++)
+    {
+      delay(delay_length);
+#pragma omp barrier
+    }
+  }
+}
+
+void test_single(int innerreps)
+{
+#pragma omp parallel
+  {
+    int j;
+    for (j = 0; j < innerreps; j++)
+    {
+#pragma omp single
+      delay(delay_length);
+    }
+  }
+}
+
+/**
+ * Mutual exclusion tests split innerreps over the threads, so innerreps sections run in total
+ */
+void test_critical(int innerreps)
+{
+#pragma omp parallel
+  {
+    int j, n = innerreps / omp_get_num_threads();
+    for (j = 0; j < n; j++)
+    {
+#pragma omp critical
+      delay(delay_length);
+    }
+  }
+}
+
+void test_lock(int innerreps)
+{
+#pragma omp parallel
+  {
+    int j, n = innerreps / omp_get_num_threads();
+    for (j = 0; j < n; j++)
+    {
+      omp_set_lock(&lock);
+      delay(delay_length);
+      omp_unset_lock(&lock);
+    }
+  }
+}
+
+void test_atomic(int innerreps)
+{
+#pragma omp parallel
+  {
+    int j, n = innerreps / omp_get_num_threads();
+    for (j = 0; j < n; j++)
+    {
+      delay(delay_length);
+#pragma omp atomic
+      shared_sum += 1.0;
+    }
+  }
+}
+
+void test_reduction(int innerreps)
+{
+  int j;
+  for (j = 0; j < innerreps; j++)
+  {
+    double sum = 0.0;
+#pragma omp parallel reduction(+:sum)
+    {
+      delay(delay_length);
+      sum += 1.0;
+    }
+    shared_sum += sum;
+  }
+}
+
+typedef struct
+{
+  const char *name;
+  void (*run)(int);
+  int per_thread; /* the reference is innerreps delays divided over the threads */
+} test_t;
+
+test_t tests[NUM_TESTS] = {
+    {"parallel", test_parallel, 0},
+    {"for", test_for, 0},
+    {"barrier", test_barrier, 0},
+    {"single", test_single, 0},
+    {"critical", test_critical, 0},
+    {"lock", test_lock, 0},
+    {"atomic", test_atomic, 1},
+    {"reduction", test_reduction, 0},
+};
+
+int compare_double(const void *a, const void *b)
+{
+  double x = *(const double *) a, y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * Median and mean of the samples, after rejecting outliers beyond 3 MADs of the median
+ * @return the number of rejected samples
+ */
+int robust_stats(double samples[], int n, double *median, double *mean)
+{
+  double dev[OUTER_REPS], mad, sum = 0;
+  int i, kept = 0;
+
+  qsort(samples, n, sizeof(double), compare_double);
+  *median = n % 2 ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+  for (i = 0; i < n; i++)
+    dev[i] = fabs(samples[i] - *median);
+  qsort(dev, n, sizeof(double), compare_double);
+  mad = dev[n / 2];
+
+  for (i = 0; i < n; i++)
+  {
+    if (mad > 0 && fabs(samples[i] - *median) > 3 * 1.4826 * mad)
+      continue;
+    sum += samples[i];
+    kept++;
+  }
+  *mean = sum / kept;
+  return n - kept;
+}
+
+/**
+ * Time per instance in microseconds of OUTER_REPS runs, with innerreps grown until one run
+ * takes TARGET_SECONDS
+ */
+void measure(void (*run)(int), double samples[])
+{
+  int innerreps = 1, r;
+  double start, elapsed;
+
+  do
+  {
+    innerreps *= 2;
+    start = omp_get_wtime();
+    run(innerreps);
+    elapsed = omp_get_wtime() - start;
+  } while (elapsed < TARGET_SECONDS && innerreps < MAX_INNER_REPS);
+
+  for (r = 0; r < OUTER_REPS; r++)
+  {
+    start = omp_get_wtime();
+    run(innerreps);
+    samples[r] = (omp_get_wtime() - start) / innerreps * 1e6;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  double delay_us = argc > 1 ? atof(argv[1]) : 0.1;
+  double samples[OUTER_REPS], ref_median, ref_mean, median, mean, grain = 0;
+  int max_threads = omp_get_max_threads(), nthreads, k, rejected;
+
+  calibrate(delay_us);
+  omp_init_lock(&lock);
+  printf("Delay: %.3f us (%d iterations), %d outer repetitions\n", delay_us, delay_length, OUTER_REPS);
+
+  measure(test_reference, samples);
+  robust_stats(samples, OUTER_REPS, &ref_median, &ref_mean);
+  printf("Reference time per delay: %.4f us\n\n", ref_median);
+
+  printf("%8s %-10s %14s %14s %10s\n", "threads", "construct", "overhead(us)", "mean(us)", "outliers");
+  for (nthreads = 1;; nthreads *= 2)
+  {
+    if (nthreads > max_threads)
+      nthreads = max_threads;
+    omp_set_num_threads(nthreads);
+
+    for (k = 0; k < NUM_TESTS; k++)
+    {
+      double ref = ref_median, ref_avg = ref_mean;
+      if (tests[k].per_thread)
+      {
+        ref /= nthreads;
+        ref_avg /= nthreads;
+      }
+      measure(tests[k].run, samples);
+      rejected = robust_stats(samples, OUTER_REPS, &median, &mean);
+      printf("%8d %-10s %14.4f %14.4f %10d\n", nthreads, tests[k].name, median - ref, mean - ref_avg, rejected);
+      if (k == 0 || k == 1)
+        grain = k == 0 ? median - ref : grain + median - ref;
+    }
+    printf("%8d %-10s %14.2f us of work per parallel loop for 1%% overhead\n\n", nthreads, "grain", grain * 100);
+
+    if (nthreads == max_threads)
+      break;
+  }
+
+  omp_destroy_lock(&lock);
+  return 0;
+}
@@ -0,0 +1,169 @@
+/**********************************
+ * DESCRIPTION: Benchmark of the parallel sorts of parallel_sort.h against std::sort and the
+ * C++17 parallel std::sort, on the four inputs of matrix-multiplication-openmp.cpp's
+ * populateVectorRandom(): random, nearly sorted, reversed and few unique.
+ *
+ * Every method sorts a fresh copy of the same input, timed by bench.h as the median over
+ * the repeats; the result is checked to be sorted and to hold the same elements (sum) as the
+ * input.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   COMPILE: g++ -O3 -march=native -fopenmp -std=c++17 parallel_sort.cpp -o parallel_sort
+ *            (add -DHAVE_PARALLEL_STL -ltbb for std::execution::par)
+ *   RUN: ./parallel_sort [-n size] [-r repeats]
+ *   Without -n the sizes 10^6, 10^7 and 10^8 are run; -n 1000000000 needs about 12 GB.
+ *
+ * USEFUL REFERENCE:
+ *    -> PARADIS: https://www.vldb.org/pvldb/vol8/p1518-cho.pdf
+ *    -> Parallel algorithms: https://en.cppreference.com/w/cpp/algorithm/execution_policy_tag_t
+**********************************/
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <functional>
+#include <climits>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <omp.h>
+#ifdef HAVE_PARALLEL_STL
+#include <execution>
+#endif
+#include "bench.h"
+#include "parallel_sort.h"
+
+using namespace std;
+
+const char *distributions[] = {"", "random", "nearly sorted", "reversed", "few unique"};
+
+/**
+ * Populate the Vector with integer numbers, as matrix-multiplication-openmp.cpp does, each
+ * thread with its own engine.
+ * flag 1: uniform in [0, m], 2: sorted with small noise, 3: reversed with small noise, 4: [0, 10]
+ */
+void populateVectorRandom(vector<int> &A, double m, int flag) {
+    random_device rd;
+    unsigned seed = rd();
+
+#pragma omp parallel
+    {
+        default_random_engine e(seed + omp_get_thread_num());
+        uniform_int_distribution<> range1(0, m);
+        uniform_int_distribution<> range3(0, 10);
+        long size = (long) A.size();
+
+#pragma omp for schedule(static)
+        for (long i = 0; i < size; i++) {
+            if (flag == 1)
+                A[i] = range1(e);
+            else if (flag == 2)
+                A[i] = (int) (i + range3(e) + 1);
+            else if (flag == 3)
+                A[i] = (int) (size * 2 - range3(e) - i);
+            else
+                A[i] = range3(e);
+        }
+    }
+}
+
+long checksum(const vector<int> &A) {
+    long sum = 0;
+#pragma omp parallel for reduction(+:sum)
+    for (size_t i = 0; i < A.size(); i++)
+        sum += A[i];
+    return sum;
+}
+
+/**
+ * Median time of a sort over the repeats, each on a fresh copy of the input
+ * @return the time, or -1 when the result is wrong
+ */
+double run(const vector<int> &input, vector<int> &work, int repeats, const function<void(vector<int> &)> &sort) {
+    long expected = checksum(input);
+    BenchOptions options;
+    options.warmup = 0;
+    options.repeats = repeats;
+
+    double median = bench_measure("sort", omp_get_max_threads(), (long) input.size(), (double) input.size(),
+                                  "elem/s", [&]() { sort(work); }, options, [&]() {
+#pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < input.size(); i++)
+            work[i] = input[i];
+    }).median;
+    if (!is_sorted(work.begin(), work.end()) || checksum(work) != expected)
+        return -1;
+    return median;
+}
+
+void print_time(double time, double reference) {
+    if (time < 0)
+        printf(" %16s", "[WRONG]");
+    else
+        printf(" %9.3f (%4.1fx)", time, reference / time);
+}
+
+/**
+ * Main function
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char *argv[]) {
+    vector<long> sizes = {1000000, 10000000, 100000000};
+    int repeats = 3, opt;
+
+    while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+        switch (opt) {
+            case 'n':
+                sizes = {atol(optarg)};
+                break;
+            case 'r':
+                repeats = max(1, atoi(optarg));
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n size] [-r repeats]\n", argv[0]);
+                return 1;
+        }
+    }
+    for (long n : sizes) {
+        if (n < 1 || n > INT_MAX / 2) {
+            fprintf(stderr, "Size must be in [1, %d]\n", INT_MAX / 2);
+            return 1;
+        }
+    }
+
+    printf("Threads: %d, times in seconds (speedup over std::sort)\n", omp_get_max_threads());
+    printf("%-14s %11s %16s %16s %16s %16s\n", "input", "size", "std::sort", "std::sort(par)",
+           "merge sort", "radix sort");
+    for (long n : sizes) {
+        vector<int> input(n), work(n);
+        for (int flag = 1; flag <= 4; flag++) {
+            populateVectorRandom(input, INT_MAX, flag);
+
+            double reference = run(input, work, repeats, [](vector<int> &v) {
+                sort(v.begin(), v.end());
+            });
+            printf("%-14s %11ld", distributions[flag], n);
+            print_time(reference, reference);
+#ifdef HAVE_PARALLEL_STL
+            print_time(run(input, work, repeats, [](vector<int> &v) {
+                sort(execution::par, v.begin(), v.end());
+            }), reference);
+#else
+            printf(" %16s", "-");
+#endif
+            print_time(run(input, work, repeats, [](vector<int> &v) {
+                parallel_merge_sort(v.data(), v.size());
+            }), reference);
+            print_time(run(input, work, repeats, [](vector<int> &v) {
+                parallel_radix_sort(v.data(), v.size());
+            }), reference);
+            printf("\n");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,332 @@
+/**********************************
+ * DESCRIPTION: OpenMP parallel sorts.
+ *
+ * parallel_merge_sort() sorts any type: the halves are sorted as tasks, ping-ponging
+ * between the data and one buffer, and merged by a parallel divide-and-conquer merge that
+ * splits the larger run at its middle and the smaller one by binary search. Runs below
+ * MERGE_CUTOFF are left to std::sort and std::merge.
+ *
+ * parallel_radix_sort() sorts integer keys in place, most significant byte first, starting
+ * at the highest byte in which the keys differ. The first pass is the parallel in-place
+ * permutation of PARADIS: the threads move elements into their stripes of every bucket at
+ * the same time, a repair step per bucket moves the leftovers to the end of the bucket, and
+ * the two repeat on what is left. The buckets are then sorted by serial American flag sort
+ * as tasks.
+ *
+ * Both run in a parallel region of their own, or as tasks when called from one.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   parallel_merge_sort(v.data(), v.size());
+ *   parallel_merge_sort(v.data(), v.size(), greater<double>());
+ *   parallel_radix_sort(keys.data(), keys.size());
+ *
+ * USEFUL REFERENCE:
+ *    -> Parallel merge: https://en.wikipedia.org/wiki/Merge_algorithm#Parallel_merge
+ *    -> PARADIS: https://www.vldb.org/pvldb/vol8/p1518-cho.pdf
+ *    -> American flag sort: https://en.wikipedia.org/wiki/American_flag_sort
+**********************************/
+#ifndef PARALLEL_SORT_H
+#define PARALLEL_SORT_H
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <vector>
+#include <cstddef>
+#include <omp.h>
+
+const size_t MERGE_CUTOFF = 1 << 14;
+const size_t RADIX_CUTOFF = 1 << 8;
+const size_t RADIX_TASK = 1 << 14;
+const size_t RADIX_PARALLEL = 1 << 20;
+
+/**
+ * Run f() in a parallel region with a single generating thread, or directly inside one
+ */
+template<class F>
+inline void parallel_sort_region(const F &f) {
+    if (omp_in_parallel()) {
+        f();
+    } else {
+#pragma omp parallel
+#pragma omp single
+        f();
+    }
+}
+
+/**
+ * Merge [a, a_end) and [b, b_end) into out
+ */
+template<class T, class Compare>
+void parallel_merge(const T *a, const T *a_end, const T *b, const T *b_end, T *out, Compare comp) {
+    size_t na = a_end - a, nb = b_end - b;
+
+    if (na + nb <= MERGE_CUTOFF) {
+        std::merge(a, a_end, b, b_end, out, comp);
+        return;
+    }
+    if (na >= nb) {
+        const T *ma = a + na / 2;
+        const T *mb = std::lower_bound(b, b_end, *ma, comp);
+        T *mo = out + (ma - a) + (mb - b);
+        *mo = *ma;
+#pragma omp task
+        parallel_merge(a, ma, b, mb, out, comp);
+        parallel_merge(ma + 1, a_end, mb, b_end, mo + 1, comp);
+    } else {
+        const T *mb = b + nb / 2;
+        const T *ma = std::upper_bound(a, a_end, *mb, comp);
+        T *mo = out + (ma - a) + (mb - b);
+        *mo = *mb;
+#pragma omp task
+        parallel_merge(a, ma, b, mb, out, comp);
+        parallel_merge(ma, a_end, mb + 1, b_end, mo + 1, comp);
+    }
+#pragma omp taskwait
+}
+
+/**
+ * Sort src[0, n), leaving the result in dst when to_dst, else in src
+ */
+template<class T, class Compare>
+void merge_sort_tasks(T *src, T *dst, size_t n, bool to_dst, Compare comp) {
+    if (n <= MERGE_CUTOFF) {
+        std::sort(src, src + n, comp);
+        if (to_dst)
+            std::copy(src, src + n, dst);
+        return;
+    }
+
+    size_t h = n / 2;
+#pragma omp task
+    merge_sort_tasks(src, dst, h, !to_dst, comp);
+    merge_sort_tasks(src + h, dst + h, n - h, !to_dst, comp);
+#pragma omp taskwait
+
+    /** The sorted halves are in the other buffer */
+    if (to_dst)
+        parallel_merge(src, src + h, src + h, src + n, dst, comp);
+    else
+        parallel_merge(dst, dst + h, dst + h, dst + n, src, comp);
+}
+
+template<class T, class Compare = std::less<T>>
+void parallel_merge_sort(T *data, size_t n, Compare comp = Compare()) {
+    if (n <= MERGE_CUTOFF) {
+        std::sort(data, data + n, comp);
+        return;
+    }
+
+    std::vector<T> buffer(n);
+    parallel_sort_region([&]() {
+        merge_sort_tasks(data, buffer.data(), n, false, comp);
+    });
+}
+
+/**
+ * Unsigned key with the order of an integer, the sign bit flipped for signed types
+ */
+template<class T>
+inline typename std::make_unsigned<T>::type radix_key(T v) {
+    typedef typename std::make_unsigned<T>::type U;
+    return std::is_signed<T>::value ? (U) v ^ ((U) 1 << (sizeof(T) * 8 - 1)) : (U) v;
+}
+
+template<class T>
+inline unsigned radix_digit(T v, int shift) {
+    return (unsigned) (radix_key(v) >> shift) & 0xFF;
+}
+
+/**
+ * In-place cycle leader permutation of the elements in [head[b], tail[b]) into their
+ * buckets, advancing head[b] past the elements it places; complete when there is one
+ * stripe per bucket, speculative when the threads share the buckets
+ */
+template<class T>
+void radix_permute(T *a, size_t *head, const size_t *tail, int shift) {
+    for (unsigned b = 0; b < 256; b++) {
+        size_t i = head[b];
+        while (i < tail[b]) {
+            T v = a[i];
+            unsigned d = radix_digit(v, shift);
+            while (d != b && head[d] < tail[d]) {
+                std::swap(v, a[head[d]++]);
+                d = radix_digit(v, shift);
+            }
+            if (d == b) {
+                a[i++] = a[head[b]];
+                a[head[b]++] = v;
+            } else {
+                a[i++] = v;
+            }
+        }
+    }
+}
+
+/**
+ * American flag sort of a[0, n) on the bytes from shift down, the buckets as tasks
+ */
+template<class T>
+void radix_sort_tasks(T *a, size_t n, int shift) {
+    if (n <= RADIX_CUTOFF) {
+        std::sort(a, a + n);
+        return;
+    }
+
+    size_t count[256] = {0}, head[256], tail[256];
+    for (size_t i = 0; i < n; i++)
+        count[radix_digit(a[i], shift)]++;
+    size_t start = 0;
+    for (unsigned b = 0; b < 256; b++) {
+        head[b] = start;
+        start += count[b];
+        tail[b] = start;
+    }
+    radix_permute(a, head, tail, shift);
+    if (shift == 0)
+        return;
+
+    for (unsigned b = 0; b < 256; b++) {
+        T *bucket = a + tail[b] - count[b];
+        size_t size = count[b];
+#pragma omp task if (size > RADIX_TASK)
+        radix_sort_tasks(bucket, size, shift - 8);
+    }
+#pragma omp taskwait
+}
+
+/**
+ * The first pass of parallel_radix_sort(), in parallel
+ * @param bucket_end  set to the end of each bucket
+ */
+template<class T>
+void radix_partition_parallel(T *a, size_t n, int shift, size_t *bucket_end) {
+    size_t gh[256], gt[256], remaining, previous = n + 1;
+    std::vector<size_t> counts;
+    std::vector<std::vector<size_t>> ph, pt;
+    bool serial = false;
+
+#pragma omp parallel
+    {
+        int t = omp_get_thread_num(), p = omp_get_num_threads();
+#pragma omp single
+        {
+            counts.assign((size_t) p * 256, 0);
+            ph.assign(p, std::vector<size_t>(256));
+            pt.assign(p, std::vector<size_t>(256));
+        }
+
+        /** Histogram of the digit, per thread */
+        size_t *local = &counts[(size_t) t * 256];
+#pragma omp for schedule(static)
+        for (size_t i = 0; i < n; i++)
+            local[radix_digit(a[i], shift)]++;
+
+#pragma omp single
+        {
+            size_t start = 0;
+            for (unsigned b = 0; b < 256; b++) {
+                gh[b] = start;
+                for (int s = 0; s < p; s++)
+                    start += counts[(size_t) s * 256 + b];
+                gt[b] = bucket_end[b] = start;
+            }
+        }
+
+        while (true) {
+#pragma omp single
+            {
+                remaining = 0;
+                for (unsigned b = 0; b < 256; b++)
+                    remaining += gt[b] - gh[b];
+                serial = remaining >= previous;
+                previous = remaining;
+            }
+            if (remaining == 0)
+                break;
+
+            /** Speculative permutation into the stripes of every bucket; one stripe when stuck */
+            for (unsigned b = 0; b < 256; b++) {
+                size_t length = gt[b] - gh[b];
+                ph[t][b] = serial ? (t == 0 ? gh[b] : gt[b]) : gh[b] + length * t / p;
+                pt[t][b] = serial ? gt[b] : gh[b] + length * (t + 1) / p;
+            }
+            radix_permute(a, ph[t].data(), pt[t].data(), shift);
+#pragma omp barrier
+
+            /** Repair: keep the placed elements at the front of each bucket, the rest behind */
+#pragma omp for schedule(dynamic)
+            for (unsigned b = 0; b < 256; b++) {
+                size_t tail = gt[b];
+                for (int s = 0; s < p; s++) {
+                    size_t head = ph[s][b];
+                    while (head < pt[s][b] && head < tail) {
+                        T v = a[head++];
+                        if (radix_digit(v, shift) == b)
+                            continue;
+                        while (head < tail) {
+                            T w = a[--tail];
+                            if (radix_digit(w, shift) == b) {
+                                a[head - 1] = w;
+                                a[tail] = v;
+                                break;
+                            }
+                        }
+                        if (head >= tail && radix_digit(a[head - 1], shift) != b)
+                            tail = head - 1;
+                    }
+                }
+                gh[b] = tail;
+            }
+        }
+    }
+}
+
+template<class T>
+void parallel_radix_sort(T *a, size_t n) {
+    static_assert(std::is_integral<T>::value, "parallel_radix_sort sorts integer keys");
+    typedef typename std::make_unsigned<T>::type U;
+
+    if (n <= RADIX_CUTOFF) {
+        std::sort(a, a + n);
+        return;
+    }
+
+    /** Start at the highest byte in which the keys differ */
+    U low = radix_key(a[0]), high = radix_key(a[0]);
+#pragma omp parallel for reduction(min:low) reduction(max:high)
+    for (size_t i = 0; i < n; i++) {
+        low = std::min(low, radix_key(a[i]));
+        high = std::max(high, radix_key(a[i]));
+    }
+    U diff = low ^ high;
+    if (diff == 0)
+        return;
+    int shift = 0;
+    while (shift + 8 < (int) sizeof(T) * 8 && (diff >> (shift + 8)) != 0)
+        shift += 8;
+
+    if (n < RADIX_PARALLEL || omp_get_max_threads() == 1 || omp_in_parallel()) {
+        parallel_sort_region([&]() {
+            radix_sort_tasks(a, n, shift);
+        });
+        return;
+    }
+
+    size_t bucket_end[256];
+    radix_partition_parallel(a, n, shift, bucket_end);
+    if (shift == 0)
+        return;
+    parallel_sort_region([&]() {
+        for (unsigned b = 0; b < 256; b++) {
+            size_t start = b == 0 ? 0 : bucket_end[b - 1];
+#pragma omp task
+            radix_sort_tasks(a + start, bucket_end[b] - start, shift - 8);
+        }
+    });
+}
+
+#endif
@@ -0,0 +1,280 @@
+/**********************************
+ * DESCRIPTION: Optional hardware performance counters for the kernels of this collection,
+ * read with the Linux perf_event_open interface, per region and per thread.
+ *
+ * Each thread opens its own counters for itself (any CPU, user space only) and closes them
+ * when it stops, so a thread is only counted between its start and stop. Events are opened
+ * one by one rather than as a group, so the kernel can multiplex them when the PMU is short
+ * of counters; the values are scaled by time enabled / time running.
+ *
+ * Counted events: task clock, cycles, instructions, L1D loads and misses, LLC references and
+ * misses. Setting PERF_COUNTERS_FP in the environment also counts the retired double
+ * precision FP instructions (Intel FP_ARITH_INST_RETIRED raw events, Skylake and later),
+ * weighted by their lanes into FLOPs. Without them the report falls back to the FLOP count
+ * the caller knows. The arithmetic intensity is FLOPs per byte of LLC miss traffic.
+ *
+ * Counters are unavailable in most containers and VMs, or when
+ * /proc/sys/kernel/perf_event_paranoid is above 2; the report then says so and the kernels
+ * run unchanged.
+ *
+ * USAGE:
+ *   perf_region_t region;
+ *   perf_region_init(&region, "matmul");
+ *   perf_region_begin(&region);      // OpenMP: every thread of the next team, or
+ *   perf_thread_start(&region, tid); //   any thread with an explicit slot
+ *   ... kernel ...
+ *   perf_region_end(&region);        // or perf_thread_stop(&region, tid)
+ *   perf_region_report(&region, flops);
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USEFUL REFERENCE:
+ *    -> perf_event_open: https://man7.org/linux/man-pages/man2/perf_event_open.2.html
+**********************************/
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define PERF_MAX_THREADS 256
+
+enum perf_event_id {
+    PERF_TASK_CLOCK,
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_LOADS,
+    PERF_L1D_MISSES,
+    PERF_LLC_REFS,
+    PERF_LLC_MISSES,
+    PERF_FP_SCALAR,
+    PERF_FP_128,
+    PERF_FP_256,
+    PERF_FP_512,
+    PERF_NUM_EVENTS
+};
+
+typedef struct {
+    const char *name;
+    int fp;                                            /* count the FP events */
+    int error;                                         /* errno of the first failed open */
+    int threads;                                       /* highest slot used + 1 */
+    int fd[PERF_MAX_THREADS][PERF_NUM_EVENTS];
+    int counted[PERF_NUM_EVENTS];                      /* threads which counted the event */
+    double value[PERF_MAX_THREADS][PERF_NUM_EVENTS];   /* scaled counts */
+} perf_region_t;
+
+#ifdef __linux__
+static inline int perf_open_event(int id) {
+    static const struct {
+        unsigned int type;
+        unsigned long long config;
+    } events[PERF_NUM_EVENTS] = {
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16)},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_RAW, 0x01C7},  /* FP_ARITH_INST_RETIRED.SCALAR_DOUBLE */
+            {PERF_TYPE_RAW, 0x04C7},  /* FP_ARITH_INST_RETIRED.128B_PACKED_DOUBLE */
+            {PERF_TYPE_RAW, 0x10C7},  /* FP_ARITH_INST_RETIRED.256B_PACKED_DOUBLE */
+            {PERF_TYPE_RAW, 0x40C7},  /* FP_ARITH_INST_RETIRED.512B_PACKED_DOUBLE */
+    };
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[id].type;
+    attr.config = events[id].config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+static inline void perf_region_init(perf_region_t *r, const char *name) {
+    int t, e;
+
+    memset(r, 0, sizeof(*r));
+    r->name = name;
+    r->fp = getenv("PERF_COUNTERS_FP") != NULL;
+    for (t = 0; t < PERF_MAX_THREADS; t++)
+        for (e = 0; e < PERF_NUM_EVENTS; e++)
+            r->fd[t][e] = -1;
+}
+
+/**
+ * Start counting the calling thread into a slot, one slot per thread
+ */
+static inline void perf_thread_start(perf_region_t *r, int slot) {
+#ifdef __linux__
+    int e, num_events = r->fp ? PERF_NUM_EVENTS : PERF_FP_SCALAR;
+
+    if (slot < 0 || slot >= PERF_MAX_THREADS)
+        return;
+    for (e = 0; e < num_events; e++) {
+        int fd = perf_open_event(e);
+        if (fd < 0) {
+            if (r->error == 0)
+                r->error = errno;
+            continue;
+        }
+        r->fd[slot][e] = fd;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#else
+    (void) slot;
+    r->error = ENOSYS;
+#endif
+}
+
+static inline void perf_thread_stop(perf_region_t *r, int slot) {
+#ifdef __linux__
+    int e, cur;
+
+    if (slot < 0 || slot >= PERF_MAX_THREADS)
+        return;
+    for (e = 0; e < PERF_NUM_EVENTS; e++) {
+        unsigned long long data[3];
+        int fd = r->fd[slot][e];
+        if (fd < 0)
+            continue;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, data, sizeof(data)) == sizeof(data) && data[2] > 0) {
+            r->value[slot][e] += (double) data[0] * data[1] / data[2];
+            __atomic_fetch_add(&r->counted[e], 1, __ATOMIC_RELAXED);
+        }
+        close(fd);
+        r->fd[slot][e] = -1;
+    }
+
+    /** Threads may be OpenMP threads or pthreads, so no OpenMP atomics here */
+    cur = __atomic_load_n(&r->threads, __ATOMIC_RELAXED);
+    while (slot + 1 > cur &&
+           !__atomic_compare_exchange_n(&r->threads, &cur, slot + 1, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+#else
+    (void) r;
+    (void) slot;
+#endif
+}
+
+#ifdef _OPENMP
+/**
+ * Start counting every thread of the team the next parallel regions will use. The runtime
+ * keeps the same threads for the same team size, so the counters follow the kernel's
+ * parallel regions until perf_region_end().
+ */
+static inline void perf_region_begin(perf_region_t *r) {
+#pragma omp parallel
+    perf_thread_start(r, omp_get_thread_num());
+}
+
+static inline void perf_region_end(perf_region_t *r) {
+#pragma omp parallel
+    perf_thread_stop(r, omp_get_thread_num());
+}
+#endif
+
+static inline double perf_total(const perf_region_t *r, int event) {
+    double sum = 0;
+    int t;
+    for (t = 0; t < r->threads; t++)
+        sum += r->value[t][event];
+    return sum;
+}
+
+static inline int perf_available(const perf_region_t *r, int event) {
+    return r->counted[event] > 0;
+}
+
+/**
+ * FLOPs from the FP events when they were counted, otherwise the caller's count
+ */
+static inline double perf_flops(const perf_region_t *r, double known_flops) {
+    if (!perf_available(r, PERF_FP_SCALAR))
+        return known_flops;
+    return perf_total(r, PERF_FP_SCALAR) + 2 * perf_total(r, PERF_FP_128) +
+           4 * perf_total(r, PERF_FP_256) + 8 * perf_total(r, PERF_FP_512);
+}
+
+static inline double perf_ratio(double num, double den) {
+    return den > 0 ? num / den : 0;
+}
+
+/**
+ * Print the counters of every thread and the derived metrics of the region
+ * @param r
+ * @param known_flops  FLOPs of the region when known, 0 otherwise
+ */
+static inline void perf_region_report(const perf_region_t *r, double known_flops) {
+    double flops = perf_flops(r, known_flops), llc_bytes = 64 * perf_total(r, PERF_LLC_MISSES);
+    int t;
+
+    printf("\n**************** Counters: %s ****************\n", r->name);
+    if (!perf_available(r, PERF_CYCLES))
+        printf("Hardware counters unavailable (%s); check /proc/sys/kernel/perf_event_paranoid\n",
+               strerror(r->error ? r->error : ENOENT));
+    if (r->threads == 0)
+        return;
+
+    printf("%6s %12s %14s %14s %6s %9s %9s\n", "thread", "busy(ms)", "cycles", "instructions", "IPC",
+           "L1D miss", "LLC miss");
+    for (t = 0; t < r->threads; t++) {
+        const double *v = r->value[t];
+        printf("%6d %12.3f %14.0f %14.0f %6.2f %8.2f%% %8.2f%%\n", t, v[PERF_TASK_CLOCK] * 1e-6,
+               v[PERF_CYCLES], v[PERF_INSTRUCTIONS], perf_ratio(v[PERF_INSTRUCTIONS], v[PERF_CYCLES]),
+               100 * perf_ratio(v[PERF_L1D_MISSES], v[PERF_L1D_LOADS]),
+               100 * perf_ratio(v[PERF_LLC_MISSES], v[PERF_LLC_REFS]));
+    }
+    printf("%6s %12.3f %14.0f %14.0f %6.2f %8.2f%% %8.2f%%\n", "total", perf_total(r, PERF_TASK_CLOCK) * 1e-6,
+           perf_total(r, PERF_CYCLES), perf_total(r, PERF_INSTRUCTIONS),
+           perf_ratio(perf_total(r, PERF_INSTRUCTIONS), perf_total(r, PERF_CYCLES)),
+           100 * perf_ratio(perf_total(r, PERF_L1D_MISSES), perf_total(r, PERF_L1D_LOADS)),
+           100 * perf_ratio(perf_total(r, PERF_LLC_MISSES), perf_total(r, PERF_LLC_REFS)));
+    if (flops > 0 && llc_bytes > 0)
+        printf("FLOPs: %.4g (%s), LLC miss traffic: %.4g bytes, arithmetic intensity: %.3f FLOP/byte\n",
+               flops, perf_available(r, PERF_FP_SCALAR) ? "counted" : "analytic", llc_bytes,
+               perf_ratio(flops, llc_bytes));
+}
+
+/**
+ * Derived metrics as JSON members, starting with a comma, for BenchResult::extra
+ */
+static inline void perf_region_json(const perf_region_t *r, double known_flops, char *buf, size_t size) {
+    double flops = perf_flops(r, known_flops), llc_bytes = 64 * perf_total(r, PERF_LLC_MISSES);
+
+    if (!perf_available(r, PERF_CYCLES)) {
+        snprintf(buf, size, ", \"busy\": %.9g", perf_total(r, PERF_TASK_CLOCK) * 1e-9);
+        return;
+    }
+    snprintf(buf, size,
+             ", \"busy\": %.9g, \"cycles\": %.0f, \"instructions\": %.0f, \"ipc\": %.4f, "
+             "\"l1d_miss_rate\": %.6f, \"llc_miss_rate\": %.6f, \"llc_miss_bytes\": %.0f, \"intensity\": %.6f",
+             perf_total(r, PERF_TASK_CLOCK) * 1e-9, perf_total(r, PERF_CYCLES), perf_total(r, PERF_INSTRUCTIONS),
+             perf_ratio(perf_total(r, PERF_INSTRUCTIONS), perf_total(r, PERF_CYCLES)),
+             perf_ratio(perf_total(r, PERF_L1D_MISSES), perf_total(r, PERF_L1D_LOADS)),
+             perf_ratio(perf_total(r, PERF_LLC_MISSES), perf_total(r, PERF_LLC_REFS)), llc_bytes,
+             perf_ratio(flops, llc_bytes));
+}
+
+#endif
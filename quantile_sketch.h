@@ -0,0 +1,152 @@
+/**********************************
+ * DESCRIPTION: A mergeable streaming quantile sketch, the merging t-digest, in a fixed-size
+ * plain struct so it can be sent over MPI as bytes and merged by a custom reduction.
+ *
+ * Values are appended to a buffer of unit centroids; when it is full, everything is sorted by
+ * mean and merged greedily into centroids whose size is bounded by the k1 scale function
+ * k(q) = delta / (2 pi) asin(2q - 1): a centroid spans at most one unit of k, so centroids
+ * are small near q = 0 and q = 1 and the tails stay accurate. The greedy merge keeps about
+ * delta / 2 centroids, so the sketch needs no value range up front and never grows, whatever
+ * the length of the stream: SKETCH_CAPACITY centroids of 16 bytes, 16 KB.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   QuantileSketch s;
+ *   sketch_init(s);
+ *   sketch_add(s, x);            // per value
+ *   sketch_merge(s, other);      // e.g. per thread or rank
+ *   double p99 = sketch_quantile(s, 0.99);
+ *
+ * USEFUL REFERENCE:
+ *    -> t-digest: https://arxiv.org/abs/1902.04023
+**********************************/
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <algorithm>
+#include <cmath>
+
+const int SKETCH_COMPRESSION = 200;
+const int SKETCH_CAPACITY = 5 * SKETCH_COMPRESSION;
+
+struct QuantileSketch {
+    int size;                        // centroids in use, compressed or not
+    int compressed;                  // whether the centroids are sorted and compressed
+    double total;                    // weight of all the centroids
+    double min;
+    double max;
+    double mean[SKETCH_CAPACITY];
+    double weight[SKETCH_CAPACITY];
+};
+
+inline void sketch_init(QuantileSketch &s) {
+    s.size = 0;
+    s.compressed = 1;
+    s.total = 0;
+    s.min = INFINITY;
+    s.max = -INFINITY;
+}
+
+/**
+ * The k1 scale function and the largest quantile a centroid starting at q0 may reach
+ */
+inline double sketch_limit(double q0) {
+    const double pi = 3.14159265358979323846;
+    double k = SKETCH_COMPRESSION / (2 * pi) * asin(2 * q0 - 1) + 1;
+    if (k >= SKETCH_COMPRESSION / 4.0)
+        return 1;
+    return (sin(k * 2 * pi / SKETCH_COMPRESSION) + 1) / 2;
+}
+
+/**
+ * Sort the centroids by mean and merge neighbours as far as the scale function allows
+ */
+inline void sketch_compress(QuantileSketch &s) {
+    if (s.compressed || s.size == 0)
+        return;
+
+    int order[SKETCH_CAPACITY];
+    double mean[SKETCH_CAPACITY], weight[SKETCH_CAPACITY];
+    for (int i = 0; i < s.size; i++)
+        order[i] = i;
+    std::sort(order, order + s.size, [&](int a, int b) {
+        return s.mean[a] < s.mean[b];
+    });
+    for (int i = 0; i < s.size; i++) {
+        mean[i] = s.mean[order[i]];
+        weight[i] = s.weight[order[i]];
+    }
+
+    /** Every centroid joins the open one or opens the next; the first opens centroid 0 */
+    int out = -1;
+    double before = 0, limit = 0;
+    for (int i = 0; i < s.size; i++) {
+        if (out >= 0 && (before + s.weight[out] + weight[i]) / s.total <= limit) {
+            s.weight[out] += weight[i];
+            s.mean[out] += (mean[i] - s.mean[out]) * weight[i] / s.weight[out];
+        } else {
+            before += out >= 0 ? s.weight[out] : 0;
+            limit = sketch_limit(before / s.total);
+            out++;
+            s.mean[out] = mean[i];
+            s.weight[out] = weight[i];
+        }
+    }
+    s.size = out + 1;
+    s.compressed = 1;
+}
+
+/**
+ * Append a centroid, compressing first when the sketch is full
+ */
+inline void sketch_add(QuantileSketch &s, double x, double w = 1) {
+    if (s.size == SKETCH_CAPACITY)
+        sketch_compress(s);
+    s.mean[s.size] = x;
+    s.weight[s.size] = w;
+    s.size++;
+    s.total += w;
+    s.min = std::min(s.min, x);
+    s.max = std::max(s.max, x);
+    s.compressed = 0;
+}
+
+/**
+ * Merge other into s
+ */
+inline void sketch_merge(QuantileSketch &s, const QuantileSketch &other) {
+    for (int i = 0; i < other.size; i++)
+        sketch_add(s, other.mean[i], other.weight[i]);
+    s.min = std::min(s.min, other.min);
+    s.max = std::max(s.max, other.max);
+}
+
+/**
+ * Estimate of quantile q in [0, 1], interpolated between the centers of the centroids and
+ * out to the minimum and maximum; NAN for an empty sketch
+ */
+inline double sketch_quantile(QuantileSketch &s, double q) {
+    if (s.size == 0)
+        return NAN;
+    sketch_compress(s);
+    if (q <= 0)
+        return s.min;
+    if (q >= 1)
+        return s.max;
+
+    double index = q * s.total, center = s.weight[0] / 2;
+    if (index < center)
+        return s.min + (s.mean[0] - s.min) * index / center;
+    for (int i = 0; i + 1 < s.size; i++) {
+        double step = (s.weight[i] + s.weight[i + 1]) / 2;
+        if (index < center + step)
+            return s.mean[i] + (s.mean[i + 1] - s.mean[i]) * (index - center) / step;
+        center += step;
+    }
+    double last = s.weight[s.size - 1] / 2;
+    return s.mean[s.size - 1] + (s.max - s.mean[s.size - 1]) * std::min(1.0, (index - center) / last);
+}
+
+#endif
@@ -0,0 +1,276 @@
+/**********************************
+ * DESCRIPTION: A program to globally sort integers distributed over MPI ranks by sample sort,
+ * each rank sorting its partition with the OpenMP radix sort of parallel_sort.h.
+ *
+ * Unlike histogram.cpp, where rank 0 generates everything and scatters it, every rank
+ * generates its own share, so the data set can be larger than one node's memory. Then:
+ *   sample      every rank draws oversampling random keys, all the samples are gathered
+ *               everywhere and sorted, and every oversampling-th one becomes a splitter
+ *   exchange    every rank buckets its keys by the splitters in parallel and the buckets
+ *               are exchanged with MPI_Alltoallv, rank r receiving bucket r of every rank
+ *   local sort  every rank sorts what it received
+ * Keys equal to a run of equal splitters are dealt round robin to the buckets sharing them,
+ * so heavy duplicates still balance. The result is checked to be sorted across the ranks,
+ * and the slowest rank's time of every phase is reported.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   COMPILE: mpicxx -std=c++11 -O3 -fopenmp sample_sort.cpp -o sample_sort
+ *   RUN: mpiexec -n < 4 or 8 > ./sample_sort [-n total] [-d distribution] [-s oversampling]
+ *   distribution 1: uniform in [0, 2^31), 2: normal around 500, 3: uniform in [1, 1000].
+ *   A rank sends and receives at most 2^31 - 1 keys.
+ *
+ * USEFUL REFERENCE:
+ *    -> MPI: https://computing.llnl.gov/tutorials/mpi/
+ *    -> Sample sort: https://en.wikipedia.org/wiki/Samplesort
+**********************************/
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <climits>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <omp.h>
+#include <mpi.h>
+#include "parallel_sort.h"
+
+#define MIN_RANGE 1
+#define MAX_RANGE 1000
+
+using namespace std;
+
+/**
+ * Helper function to populate the local share randomly, each thread with its own engine.
+ * @param data
+ * @param length
+ * @param flag
+ * @param seed
+ */
+void populateVectorRandom(int data[], long length, int flag, unsigned seed) {
+#pragma omp parallel
+    {
+        mt19937 engine(seed + 7919 * omp_get_thread_num());
+        uniform_int_distribution<> u(0, INT_MAX);
+        uniform_int_distribution<> few(MIN_RANGE, MAX_RANGE);
+        normal_distribution<double> n(500, 1.0);
+
+#pragma omp for schedule(static)
+        for (long i = 0; i < length; i++) {
+            if (flag == 1)
+                data[i] = u(engine);
+            else if (flag == 2)
+                data[i] = (int) lround(n(engine));
+            else
+                data[i] = few(engine);
+        }
+    }
+}
+
+/**
+ * Splitters from oversampling random keys of every rank
+ * @param local
+ * @param oversampling
+ * @param num_procs
+ * @param rank_id
+ * @return num_procs - 1 splitters
+ */
+vector<int> chooseSplitters(const vector<int> &local, int oversampling, int num_procs, int rank_id) {
+    vector<int> samples(oversampling), all_samples((size_t) oversampling * num_procs), splitters;
+    mt19937_64 engine(12345 + rank_id);
+
+    for (int i = 0; i < oversampling; i++)
+        samples[i] = local.empty() ? INT_MAX : local[engine() % local.size()];
+    MPI_Allgather(samples.data(), oversampling, MPI_INT, all_samples.data(), oversampling, MPI_INT,
+                  MPI_COMM_WORLD);
+    sort(all_samples.begin(), all_samples.end());
+    for (int r = 1; r < num_procs; r++)
+        splitters.push_back(all_samples[(size_t) r * oversampling]);
+    return splitters;
+}
+
+/**
+ * Bucket of a key: the first splitter not below it, round robin over a run of equal splitters
+ */
+inline int bucketOf(int key, long i, const vector<int> &splitters) {
+    int lo = (int) (lower_bound(splitters.begin(), splitters.end(), key) - splitters.begin());
+    if (lo == (int) splitters.size() || splitters[lo] != key)
+        return lo;
+    int hi = (int) (upper_bound(splitters.begin(), splitters.end(), key) - splitters.begin());
+    return lo + (int) (i % (hi - lo + 1));
+}
+
+/**
+ * Bucket the local keys by the splitters and exchange the buckets
+ * @param local
+ * @param splitters
+ * @param num_procs
+ * @return the keys of this rank's bucket from every rank
+ */
+vector<int> exchange(vector<int> &local, const vector<int> &splitters, int num_procs) {
+    long n = (long) local.size();
+    vector<int> dest(n), send(n), send_counts(num_procs), recv_counts(num_procs),
+            send_displs(num_procs), recv_displs(num_procs);
+    vector<long> offsets;
+
+    /** Per-thread counts per destination, turned into each thread's positions in send */
+#pragma omp parallel
+    {
+        int t = omp_get_thread_num(), num_threads = omp_get_num_threads();
+#pragma omp single
+        offsets.assign((size_t) num_threads * num_procs, 0);
+        long *offset = &offsets[(size_t) t * num_procs];
+
+#pragma omp for schedule(static)
+        for (long i = 0; i < n; i++) {
+            dest[i] = bucketOf(local[i], i, splitters);
+            offset[dest[i]]++;
+        }
+
+#pragma omp single
+        {
+            long position = 0;
+            for (int d = 0; d < num_procs; d++) {
+                long start = position;
+                for (int s = 0; s < num_threads; s++) {
+                    long count = offsets[(size_t) s * num_procs + d];
+                    offsets[(size_t) s * num_procs + d] = position;
+                    position += count;
+                }
+                send_counts[d] = (int) (position - start);
+                send_displs[d] = (int) start;
+            }
+        }
+
+#pragma omp for schedule(static)
+        for (long i = 0; i < n; i++)
+            send[offset[dest[i]]++] = local[i];
+    }
+    vector<int>().swap(dest);
+    vector<int>().swap(local);
+
+    MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    long total = 0;
+    for (int r = 0; r < num_procs; r++) {
+        recv_displs[r] = (int) total;
+        total += recv_counts[r];
+    }
+
+    vector<int> received(total);
+    MPI_Alltoallv(send.data(), send_counts.data(), send_displs.data(), MPI_INT,
+                  received.data(), recv_counts.data(), recv_displs.data(), MPI_INT, MPI_COMM_WORLD);
+    return received;
+}
+
+/**
+ * Check the partitions are sorted, in rank order, and hold all the keys
+ * @return 0 when correct
+ */
+int check(const vector<int> &sorted, long num_data, int rank_id) {
+    int ok = is_sorted(sorted.begin(), sorted.end()),
+            first = sorted.empty() ? INT_MAX : sorted.front(),
+            last = sorted.empty() ? INT_MIN : sorted.back(),
+            prev_last = INT_MIN,
+            all_ok;
+    long count = (long) sorted.size(), total;
+
+    /** The largest key of the ranks before, which empty partitions pass on */
+    MPI_Exscan(&last, &prev_last, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if (rank_id == 0)
+        prev_last = INT_MIN;
+    ok = ok && prev_last <= first;
+
+    MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+    MPI_Allreduce(&count, &total, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+    return all_ok && total == num_data ? 0 : 1;
+}
+
+/**
+ * Main function
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char *argv[]) {
+    int rank_id,
+            num_procs,
+            provided,
+            flag = 1,
+            oversampling = 64,
+            opt,
+            rc;
+    long num_data = 100000000,
+            local_num_data;
+    double start,
+            times[4],
+            max_times[4];
+
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank_id);
+
+    while ((opt = getopt(argc, argv, "n:d:s:")) != -1) {
+        switch (opt) {
+            case 'n':
+                num_data = atol(optarg);
+                break;
+            case 'd':
+                flag = atoi(optarg);
+                break;
+            case 's':
+                oversampling = atoi(optarg);
+                break;
+            default:
+                if (rank_id == 0)
+                    fprintf(stderr, "Usage: %s [-n total] [-d 1|2|3] [-s oversampling]\n", argv[0]);
+                MPI_Finalize();
+                return 1;
+        }
+    }
+    if (num_data < 0 || flag < 1 || flag > 3 || oversampling < 1) {
+        if (rank_id == 0)
+            fprintf(stderr, "Invalid arguments\n");
+        MPI_Finalize();
+        return 1;
+    }
+
+    /** Every rank generates its own share */
+    local_num_data = num_data / num_procs + (rank_id < num_data % num_procs);
+    vector<int> local(local_num_data);
+    populateVectorRandom(local.data(), local_num_data, flag, 1000003u * (rank_id + 1));
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    start = MPI_Wtime();
+    vector<int> splitters = chooseSplitters(local, oversampling, num_procs, rank_id);
+    times[0] = MPI_Wtime() - start;
+
+    start = MPI_Wtime();
+    vector<int> sorted = exchange(local, splitters, num_procs);
+    times[1] = MPI_Wtime() - start;
+
+    start = MPI_Wtime();
+    parallel_radix_sort(sorted.data(), sorted.size());
+    times[2] = MPI_Wtime() - start;
+    times[3] = times[0] + times[1] + times[2];
+
+    MPI_Reduce(times, max_times, 4, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    long size = (long) sorted.size(), max_size;
+    MPI_Reduce(&size, &max_size, 1, MPI_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+    rc = check(sorted, num_data, rank_id);
+
+    if (rank_id == 0) {
+        printf("Ranks: %d, threads per rank: %d, keys: %ld, distribution: %d, oversampling: %d\n",
+               num_procs, omp_get_max_threads(), num_data, flag, oversampling);
+        printf("Slowest rank per phase (s): sample %.4f, exchange %.4f, local sort %.4f, total %.4f\n",
+               max_times[0], max_times[1], max_times[2], max_times[3]);
+        printf("Largest partition: %ld keys, %.3f of the mean\n", max_size,
+               num_data > 0 ? (double) max_size * num_procs / num_data : 0.0);
+        printf("Checking the calculation result...%s\n", rc == 0 ? "[CORRECT]" : "[WRONG]");
+    }
+
+    MPI_Finalize();
+    return rc;
+}
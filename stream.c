@@ -0,0 +1,287 @@
+/**********************************
+ * DESCRIPTION: STREAM-style memory bandwidth kernels (copy, scale, add, triad) using OpenMP.
+ * The best triad rate is the bandwidth ceiling of the roofline the matrix kernels of this
+ * collection should be compared against.
+ *
+ * Every kernel is run a number of times and reported by its minimum time, skipping the first
+ * run. With "-s" the kernels write with non-temporal (streaming) stores, which bypass the
+ * cache and avoid the read-for-ownership of the destination; this only pays off once the
+ * arrays are much larger than the last level cache.
+ *
+ * Author: Kejie Zhang
+ * LAST UPDATED: 10/18/2026
+ *
+ * USAGE:
+ *   COMPILE: gcc -O3 -march=native -fopenmp stream.c -o stream
+ *   RUN: ./stream [-n elements] [-r repeats] [-s]
+ *
+ * USEFUL REFERENCE:
+ *    -> STREAM: https://www.cs.virginia.edu/stream/
+ *    -> Roofline: https://crd.lbl.gov/divisions/amcr/computer-science-amcr/par/research/roofline/
+**********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <unistd.h>
+#include <omp.h>
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#define DEFAULT_N (1L << 25)
+#define DEFAULT_REPEATS 10
+#define SCALAR 3.0
+#define NUM_KERNELS 4
+
+const char *kernel_names[NUM_KERNELS] = {"Copy", "Scale", "Add", "Triad"};
+const int kernel_arrays[NUM_KERNELS] = {2, 2, 3, 3};
+
+/**
+ * The [lo, hi) range of the calling thread, starting on a 64 byte boundary
+ * @param n
+ * @param lo
+ * @param hi
+ */
+void thread_range(long n, long *lo, long *hi) {
+    int t = omp_get_thread_num(), nt = omp_get_num_threads();
+    long per = ((n + nt - 1) / nt + 7) & ~7L;
+    *lo = t * per < n ? t * per : n;
+    *hi = *lo + per < n ? *lo + per : n;
+}
+
+/**
+ * Non-temporal stores of four (or two) doubles, plain stores without SIMD
+ */
+#if defined(__AVX__)
+#define NT_WIDTH 4
+#define NT_STORE(p, expr) _mm256_stream_pd((p), (expr))
+#define V_LOAD(p) _mm256_load_pd(p)
+#define V_SET1(x) _mm256_set1_pd(x)
+#define V_ADD(x, y) _mm256_add_pd(x, y)
+#define V_MUL(x, y) _mm256_mul_pd(x, y)
+#define V_TYPE __m256d
+#elif defined(__SSE2__)
+#define NT_WIDTH 2
+#define NT_STORE(p, expr) _mm_stream_pd((p), (expr))
+#define V_LOAD(p) _mm_load_pd(p)
+#define V_SET1(x) _mm_set1_pd(x)
+#define V_ADD(x, y) _mm_add_pd(x, y)
+#define V_MUL(x, y) _mm_mul_pd(x, y)
+#define V_TYPE __m128d
+#endif
+
+void copy(double *restrict c, const double *restrict a, long n, bool nt) {
+    long i;
+#ifdef NT_WIDTH
+    if (nt) {
+#pragma omp parallel private(i)
+        {
+            long lo, hi;
+            thread_range(n, &lo, &hi);
+            for (i = lo; i + NT_WIDTH <= hi; i += NT_WIDTH)
+                NT_STORE(c + i, V_LOAD(a + i));
+            for (; i < hi; i++)
+                c[i] = a[i];
+            _mm_sfence();
+        }
+        return;
+    }
+#endif
+#pragma omp parallel for simd schedule(static)
+    for (i = 0; i < n; i++)
+        c[i] = a[i];
+}
+
+void scale(double *restrict b, const double *restrict c, double s, long n, bool nt) {
+    long i;
+#ifdef NT_WIDTH
+    if (nt) {
+#pragma omp parallel private(i)
+        {
+            long lo, hi;
+            V_TYPE vs = V_SET1(s);
+            thread_range(n, &lo, &hi);
+            for (i = lo; i + NT_WIDTH <= hi; i += NT_WIDTH)
+                NT_STORE(b + i, V_MUL(vs, V_LOAD(c + i)));
+            for (; i < hi; i++)
+                b[i] = s * c[i];
+            _mm_sfence();
+        }
+        return;
+    }
+#endif
+#pragma omp parallel for simd schedule(static)
+    for (i = 0; i < n; i++)
+        b[i] = s * c[i];
+}
+
+void add(double *restrict c, const double *restrict a, const double *restrict b, long n, bool nt) {
+    long i;
+#ifdef NT_WIDTH
+    if (nt) {
+#pragma omp parallel private(i)
+        {
+            long lo, hi;
+            thread_range(n, &lo, &hi);
+            for (i = lo; i + NT_WIDTH <= hi; i += NT_WIDTH)
+                NT_STORE(c + i, V_ADD(V_LOAD(a + i), V_LOAD(b + i)));
+            for (; i < hi; i++)
+                c[i] = a[i] + b[i];
+            _mm_sfence();
+        }
+        return;
+    }
+#endif
+#pragma omp parallel for simd schedule(static)
+    for (i = 0; i < n; i++)
+        c[i] = a[i] + b[i];
+}
+
+void triad(double *restrict a, const double *restrict b, const double *restrict c, double s, long n, bool nt) {
+    long i;
+#ifdef NT_WIDTH
+    if (nt) {
+#pragma omp parallel private(i)
+        {
+            long lo, hi;
+            V_TYPE vs = V_SET1(s);
+            thread_range(n, &lo, &hi);
+            for (i = lo; i + NT_WIDTH <= hi; i += NT_WIDTH)
+                NT_STORE(a + i, V_ADD(V_LOAD(b + i), V_MUL(vs, V_LOAD(c + i))));
+            for (; i < hi; i++)
+                a[i] = b[i] + s * c[i];
+            _mm_sfence();
+        }
+        return;
+    }
+#endif
+#pragma omp parallel for simd schedule(static)
+    for (i = 0; i < n; i++)
+        a[i] = b[i] + s * c[i];
+}
+
+/**
+ * Check the arrays against the values the kernels must have produced
+ * @return 0 when the average relative error is small
+ */
+int check(const double *a, const double *b, const double *c, long n, int repeats) {
+    double aj = 1.0, bj = 2.0, cj = 0.0, a_err = 0, b_err = 0, c_err = 0;
+    long i;
+    int r;
+
+    for (r = 0; r < repeats; r++) {
+        cj = aj;
+        bj = SCALAR * cj;
+        cj = aj + bj;
+        aj = bj + SCALAR * cj;
+    }
+
+#pragma omp parallel for reduction(+:a_err, b_err, c_err)
+    for (i = 0; i < n; i++) {
+        a_err += fabs(a[i] - aj);
+        b_err += fabs(b[i] - bj);
+        c_err += fabs(c[i] - cj);
+    }
+    return a_err / n / fabs(aj) > 1e-13 || b_err / n / fabs(bj) > 1e-13 || c_err / n / fabs(cj) > 1e-13;
+}
+
+int main(int argc, char *argv[]) {
+    long n = DEFAULT_N, i;
+    int repeats = DEFAULT_REPEATS, opt, r, k;
+    bool nt = false;
+    double *a, *b, *c, t, times[NUM_KERNELS][3];
+
+    while ((opt = getopt(argc, argv, "n:r:s")) != -1) {
+        switch (opt) {
+            case 'n':
+                n = (long) strtod(optarg, NULL);
+                break;
+            case 'r':
+                repeats = atoi(optarg);
+                break;
+            case 's':
+                nt = true;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n elements] [-r repeats] [-s]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (repeats < 2)
+        repeats = 2;
+#ifndef NT_WIDTH
+    if (nt)
+        printf("Non-temporal stores are not available on this target, using plain stores\n");
+#endif
+
+    a = aligned_alloc(64, ((n * sizeof(double) + 63) & ~63L));
+    b = aligned_alloc(64, ((n * sizeof(double) + 63) & ~63L));
+    c = aligned_alloc(64, ((n * sizeof(double) + 63) & ~63L));
+    if (a == NULL || b == NULL || c == NULL) {
+        fprintf(stderr, "Cannot allocate 3 x %ld doubles\n", n);
+        return 1;
+    }
+
+    printf("Array size: %ld elements, %.1f MiB per array, %.1f MiB total\n",
+           n, n * sizeof(double) / 1048576.0, 3.0 * n * sizeof(double) / 1048576.0);
+    printf("Threads: %d, repeats: %d, stores: %s\n",
+           omp_get_max_threads(), repeats, nt ? "non-temporal" : "regular");
+
+    /** First touch with the same static schedule as the kernels */
+#pragma omp parallel for schedule(static)
+    for (i = 0; i < n; i++) {
+        a[i] = 1.0;
+        b[i] = 2.0;
+        c[i] = 0.0;
+    }
+
+    for (k = 0; k < NUM_KERNELS; k++) {
+        times[k][0] = 1e30;
+        times[k][1] = 0;
+        times[k][2] = 0;
+    }
+
+    for (r = 0; r < repeats; r++) {
+        for (k = 0; k < NUM_KERNELS; k++) {
+            t = omp_get_wtime();
+            switch (k) {
+                case 0:
+                    copy(c, a, n, nt);
+                    break;
+                case 1:
+                    scale(b, c, SCALAR, n, nt);
+                    break;
+                case 2:
+                    add(c, a, b, n, nt);
+                    break;
+                default:
+                    triad(a, b, c, SCALAR, n, nt);
+            }
+            t = omp_get_wtime() - t;
+
+            /** The first run pays for page faults and cold caches */
+            if (r > 0) {
+                times[k][0] = t < times[k][0] ? t : times[k][0];
+                times[k][1] += t;
+                times[k][2] = t > times[k][2] ? t : times[k][2];
+            }
+        }
+    }
+
+    printf("%-10s %14s %12s %12s %12s\n", "Function", "Best GB/s", "Avg time", "Min time", "Max time");
+    for (k = 0; k < NUM_KERNELS; k++) {
+        double bytes = (double) kernel_arrays[k] * n * sizeof(double);
+        printf("%-10s %14.2f %12.6f %12.6f %12.6f\n", kernel_names[k], bytes / times[k][0] * 1e-9,
+               times[k][1] / (repeats - 1), times[k][0], times[k][2]);
+    }
+    printf("Roofline bandwidth ceiling (best Triad): %.2f GB/s\n",
+           3.0 * n * sizeof(double) / times[3][0] * 1e-9);
+
+    printf("Checking the calculation result...%s\n", check(a, b, c, n, repeats) == 0 ? "[CORRECT]" : "[WRONG]");
+
+    free(a);
+    free(b);
+    free(c);
+    return 0;
+}